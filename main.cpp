@@ -1,34 +1,83 @@
 #include "src/scanner/scanner.h"
+#include "src/scanner/source.h"
 #include "src/utils/logger.h"
 #include "src/parser/parser.h"
 #include "src/AST/AST.h"
 #include "src/AST/ASTVisitor.h"
 #include "src/AST/ASTPrinter.h"
 #include "src/AST/ASTPrinterJson.h"
+#include "src/AST/FlatAST.h"
 #include "src/Semantics/SemanticAnalyzer.h"
-#include <fstream>
 
-int main() {
-    std::ifstream inputFile("input2.1.txt");
-    std::string sourceCode((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
+// Compiles one top-level declaration at a time: each one is parsed,
+// analyzed against the global scope and its symbol tables rendered, and then
+// its subtree and local scopes are freed before the next one is read. Peak
+// memory is set by the largest declaration instead of the whole file.
+//
+// Messages and exit codes are the same as the whole-file path, and so are the
+// symbol tables, with two differences that come from not keeping the tree:
+// the local tables of each declaration are printed as soon as it is analyzed,
+// so they come before the result line and the global table, and the ones
+// printed before the first semantic error stay on the output. After that
+// error no more tables are printed. The JSON dump names nodes by address and
+// lists all of them at the end, so it is only written by the whole-file path.
+static int compileStreaming(SourceFile& sourceFile) {
+    ASTContext context;
+    Scanner s(sourceFile);
+    Parser p(context, s);
+    SemanticAnalyzer sem;
 
-    Scanner s(sourceCode);
-    s.scan();
+    ASTNode* declaration;
+    while (p.parseDeclaration(declaration)) {
+        // After a syntax error the rest is only parsed, to report its errors.
+        if (declaration && p.getErrors().empty()) {
+            sem.AnalyzeDeclaration(*declaration);
+            if (!sem.HasError()) {
+                sem.RenderLocalScopes();
+            }
+            sem.ReleaseLocalScopes();
+        }
+        context.Reset();
+    }
 
-    const std::vector<Token>& tokens = s.getTokens();
+    if (!p.getErrors().empty()) {
+        // getAST() logs the same failure line as the whole-file path.
+        p.getAST();
+        return 1;
+    }
+    if (sem.HasError()) {
+        std::cerr << "Analisis semantico fallo.\n";
+        return 1;
+    }
+    std::cout << "Analisis semantico completado con exito.\n";
+    sem.Render();
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    SourceManager sources;
+    SourceFile* sourceFile = sources.loadFile("input2.1.txt");
+    if (!sourceFile) {
+        return 1;
+    }
 
     Logger& logger = Logger::getInstance();
     logger.setLogLevel(Logger::LogLevel::ERROR);
     logger.setActive(true);
 
-    for (auto token : tokens) {
-        token.print();
+    if (argc > 1 && std::string(argv[1]) == "--stream") {
+        return compileStreaming(*sourceFile);
     }
 
-    Parser p(tokens);
-    p.parse();
+    // The whole file is scanned first so that large inputs can split their
+    // top-level declarations across threads; small ones parse sequentially.
+    Scanner s(*sourceFile);
+    s.scan();
+    ASTContext context;
+    Parser p(context, s.getTokens());
+    p.parseParallel();
 
-    UnqPtr<ProgramNode> ast = p.getAST();
+    ProgramNode* ast = p.getAST();
     if (!ast) {
         return 1;
     }
@@ -44,8 +93,16 @@ int main() {
 
     sem.Render();
     
+    // The JSON is written from the flat copy of the tree (see FlatAST.h).
+    // Build() only fails for tokens that are not in this buffer, which would
+    // be a parser bug; the file is not written then.
+    FlatAST flat(s.getTokens());
+    if (!flat.Build(*ast)) {
+        std::cerr << "No se pudo generar ASTTree.json.\n";
+        return 1;
+    }
     std::string filename = "ASTTree.json";
     ASTPrinterJson printer(filename);
-    ast->Accept(printer);
+    printer.Print(flat);
     return 0;
 }
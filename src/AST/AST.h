@@ -37,56 +37,122 @@ clases
     - ExprListNode
 * */
 
-#include <memory>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#include "ASTContext.h"
 #include "ASTVisitor.h"
 #include "../scanner/token.h"
+#include "../utils/casting.h"
+#include "../utils/stack.h"
+
+// Una etiqueta por clase concreta de nodo. StaticVisitor despacha con un
+// switch sobre ella en vez de llamar a Accept(), e isa/dyn_cast
+// (utils/casting.h) la comparan en vez de usar RTTI. Las subclases de una
+// misma base van seguidas: sus classof() comprueban un rango.
+enum class NodeKind : uint8_t {
+    Program,
+    VarDeclaration,
+    FunctionDeclaration,
+    Param,
+    ParamList,
+    Assignment,
+    BinaryOperation,
+    Relational,
+    Equality,
+    LogicalOr,
+    LogicalAnd,
+    UnaryOperation,
+    Literal,
+    Identifier,
+    Type,
+    IfStatement,
+    ForStatement,
+    ReturnStatement,
+    PrintStatement,
+    ExpressionStatement,
+    CompoundStatement,
+    ExprList,
+    FunctionCall,
+    Indexing,
+};
 
-template<typename T>
-using UnqPtr = std::unique_ptr<T>;
-
+// Los nodos viven en un ASTContext, que los libera a todos juntos; nunca se
+// destruyen a través de un ASTNode*, así que el destructor no es virtual.
 class ASTNode {
 public:
-    virtual ~ASTNode() = default;
-    std::string parentID;
     virtual void Accept(ASTNodeVisitor& v) = 0;
-    virtual void SetChildrenPrintID(const std::string& pID) = 0;
+
+    const NodeKind kind;
+
+protected:
+    explicit ASTNode(NodeKind kind) : kind(kind) {}
+    ~ASTNode() = default;
+};
+
+// Accept() de cada nodo: los visitantes recorren el árbol recursivamente y,
+// si la pila se acaba, la visita sigue en un segmento nuevo (utils/stack.h).
+template<typename Node>
+void VisitStackSafe(ASTNodeVisitor& visitor, Node& node) {
+    if (Stack::isLow()) {
+        Stack::onNewSegment([&] { visitor.Visit(node); });
+        return;
+    }
+    visitor.Visit(node);
+}
+
+// Bytes [begin, end) del fuente que ocupa una declaración, desde su primer
+// token hasta el final del último.
+struct SourceRange {
+    uint32_t begin;
+    uint32_t end;
 };
 
 class ProgramNode : public ASTNode {
 public:
-    std::vector<UnqPtr<ASTNode>> declarations;
+    std::vector<ASTNode*> declarations;
+    // extents[i] es el rango de declarations[i]. El parser los rellena y
+    // Parser::reparse() los usa para saber qué declaraciones tocó una edición.
+    std::vector<SourceRange> extents;
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) override {
-        for (auto& decl : declarations) decl->parentID = pID;
-    }
-    void AddDeclaration(UnqPtr<ASTNode> declaration) {
-        declarations.push_back(std::move(declaration));
+    ProgramNode() : ASTNode(NodeKind::Program) {}
+
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Program; }
+
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
+    void AddDeclaration(ASTNode* declaration, SourceRange extent) {
+        declarations.push_back(declaration);
+        extents.push_back(extent);
     }
 };
 
 class DeclarationNode : public ASTNode {
 public:
-    void Accept(ASTNodeVisitor& v) override = 0;
-    void SetChildrenPrintID(const std::string& pID) override {
-        parentID = pID;
+    static bool classof(const ASTNode* node) {
+        return node->kind >= NodeKind::VarDeclaration && node->kind <= NodeKind::FunctionDeclaration;
     }
+
+    void Accept(ASTNodeVisitor& v) override = 0;
+
+protected:
+    explicit DeclarationNode(NodeKind kind) : ASTNode(kind) {}
 };
 
 class VarDeclarationNode : public DeclarationNode {
 public:
     Token type;
     Token identifier;
-    UnqPtr<ASTNode> expression;  // opcional
+    ASTNode* expression;  // opcional
 
-    VarDeclarationNode(const Token& t, const Token& id, UnqPtr<ASTNode> expr = nullptr)
-        : type(t), identifier(id), expression(std::move(expr)) {}
+    VarDeclarationNode(const Token& t, const Token& id, ASTNode* expr = nullptr)
+        : DeclarationNode(NodeKind::VarDeclaration), type(t), identifier(id), expression(expr) {}
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) override {
-        if (expression) expression->parentID = pID;
-    }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::VarDeclaration; }
+
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
 };
 
 class ParamNode : public ASTNode {
@@ -94,94 +160,121 @@ public:
     Token type;
     Token identifier;
 
-    ParamNode(const Token& t, const Token& id) : type(t), identifier(id) {}
+    ParamNode(const Token& t, const Token& id) : ASTNode(NodeKind::Param), type(t), identifier(id) {}
+
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Param; }
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) noexcept override {}
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
 };
 
 class FunctionDeclarationNode : public DeclarationNode {
 public:
     Token returnType;
     Token functionName;
-    std::vector<UnqPtr<ParamNode>> parameters;
-    UnqPtr<ASTNode> body;
+    std::vector<ParamNode*> parameters;
+    ASTNode* body;  // vacío mientras el cuerpo esté aplazado
+    // Modo esqueleto del parser: analiza el cuerpo la primera vez que se pide.
+    std::function<ASTNode*()> deferredBody;
+
+    FunctionDeclarationNode(const Token& retType, const Token& name, std::vector<ParamNode*> params, ASTNode* b)
+        : DeclarationNode(NodeKind::FunctionDeclaration), returnType(retType), functionName(name),
+          parameters(std::move(params)), body(b) {}
+
+    // El cuerpo, analizándolo si estaba aplazado. nullptr si tenía errores
+    // de sintaxis, que se informan al analizarlo.
+    ASTNode* Body() {
+        if (deferredBody) {
+            body = deferredBody();
+            deferredBody = nullptr;
+        }
+        return body;
+    }
 
-    FunctionDeclarationNode(const Token& retType, const Token& name, std::vector<UnqPtr<ParamNode>> params, UnqPtr<ASTNode> b)
-        : returnType(retType), functionName(name), parameters(std::move(params)), body(std::move(b)) {}
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::FunctionDeclaration; }
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) override {
-        for (auto& param : parameters) param->parentID = pID;
-        if (body) body->parentID = pID;
-    }
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
 };
 
-class ExpressionNode : public ASTNode {};
+class ExpressionNode : public ASTNode {
+public:
+    static bool classof(const ASTNode* node) {
+        return node->kind >= NodeKind::Assignment && node->kind <= NodeKind::Identifier;
+    }
+
+protected:
+    explicit ExpressionNode(NodeKind kind) : ASTNode(kind) {}
+};
 
 class AssignmentNode : public ExpressionNode {
 public:
-    UnqPtr<ASTNode> left;
+    ASTNode* left;
     Token op;
-    UnqPtr<ASTNode> right;
+    ASTNode* right;
 
-    AssignmentNode(UnqPtr<ASTNode> l, const Token& o, UnqPtr<ASTNode> r)
-        : left(std::move(l)), op(o), right(std::move(r)) {}
+    AssignmentNode(ASTNode* l, const Token& o, ASTNode* r)
+        : ExpressionNode(NodeKind::Assignment), left(l), op(o), right(r) {}
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) override {
-        left->parentID = pID;
-        right->parentID = pID;
-    }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Assignment; }
+
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
 };
 
 class BinaryOperationNode : public ExpressionNode {
 public:
-    UnqPtr<ASTNode> left;
+    ASTNode* left;
     Token op;
-    UnqPtr<ASTNode> right;
+    ASTNode* right;
 
-    BinaryOperationNode(UnqPtr<ASTNode> l, const Token& o, UnqPtr<ASTNode> r)
-        : left(std::move(l)), op(o), right(std::move(r)) {}
+    BinaryOperationNode(ASTNode* l, const Token& o, ASTNode* r)
+        : BinaryOperationNode(NodeKind::BinaryOperation, l, o, r) {}
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) override {
-        left->parentID = pID;
-        right->parentID = pID;
+    static bool classof(const ASTNode* node) {
+        return node->kind >= NodeKind::BinaryOperation && node->kind <= NodeKind::LogicalAnd;
     }
+
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
+
+protected:
+    // Para RelationalNode, EqualityNode y los nodos lógicos.
+    BinaryOperationNode(NodeKind kind, ASTNode* l, const Token& o, ASTNode* r)
+        : ExpressionNode(kind), left(l), op(o), right(r) {}
 };
 
 class UnaryOperationNode : public ExpressionNode {
 public:
     Token op;
-    UnqPtr<ASTNode> expr;
+    ASTNode* expr;
 
-    UnaryOperationNode(const Token& o, UnqPtr<ASTNode> e) : op(o), expr(std::move(e)) {}
+    UnaryOperationNode(const Token& o, ASTNode* e) : ExpressionNode(NodeKind::UnaryOperation), op(o), expr(e) {}
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) override {
-        expr->parentID = pID;
-    }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::UnaryOperation; }
+
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
 };
 
 class LiteralNode : public ExpressionNode {
 public:
     Token literal;
+    // Integer, character code or 0/1 for booleans, decoded by the scanner.
+    int64_t value;
 
-    LiteralNode(const Token& lit) : literal(lit) {}
+    LiteralNode(const Token& lit)
+        : ExpressionNode(NodeKind::Literal), literal(lit), value(static_cast<int64_t>(lit.literal)) {}
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) noexcept override {}
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Literal; }
+
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
 };
 
 class IdentifierNode : public ExpressionNode {
 public:
     Token identifier;
 
-    IdentifierNode(const Token& id) : identifier(id) {}
+    IdentifierNode(const Token& id) : ExpressionNode(NodeKind::Identifier), identifier(id) {}
+
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Identifier; }
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) noexcept override {}
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
 };
 
 class TypeNode : public ASTNode {
@@ -189,190 +282,197 @@ public:
     Token type;
     bool isArray;
 
-    TypeNode(const Token& t, bool array = false) : type(t), isArray(array) {}
+    TypeNode(const Token& t, bool array = false) : ASTNode(NodeKind::Type), type(t), isArray(array) {}
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) noexcept override {}
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Type; }
+
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
 };
 
-class StatementNode : public ASTNode {};
+class StatementNode : public ASTNode {
+public:
+    static bool classof(const ASTNode* node) {
+        return node->kind >= NodeKind::IfStatement && node->kind <= NodeKind::CompoundStatement;
+    }
+
+protected:
+    explicit StatementNode(NodeKind kind) : ASTNode(kind) {}
+};
 
 class IfStatementNode : public StatementNode {
 public:
-    UnqPtr<ASTNode> condition;
-    UnqPtr<ASTNode> ifBody;
-    UnqPtr<ASTNode> elseBody;
-
-    IfStatementNode(UnqPtr<ASTNode> cond, UnqPtr<ASTNode> ifB, UnqPtr<ASTNode> elseB = nullptr)
-        : condition(std::move(cond)), ifBody(std::move(ifB)), elseBody(std::move(elseB)) {}
-
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) override {
-        condition->parentID = pID;
-        ifBody->parentID = pID;
-        if (elseBody) elseBody->parentID = pID;
-    }
+    ASTNode* condition;
+    ASTNode* ifBody;
+    ASTNode* elseBody;
+
+    IfStatementNode(ASTNode* cond, ASTNode* ifB, ASTNode* elseB = nullptr)
+        : StatementNode(NodeKind::IfStatement), condition(cond), ifBody(ifB), elseBody(elseB) {}
+
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::IfStatement; }
+
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
 };
 
 class ForStatementNode : public StatementNode {
 public:
-    UnqPtr<ASTNode> init;
-    UnqPtr<ASTNode> condition;
-    UnqPtr<ASTNode> increment;
-    UnqPtr<ASTNode> body;
-
-    ForStatementNode(UnqPtr<ASTNode> i, UnqPtr<ASTNode> cond, UnqPtr<ASTNode> inc, UnqPtr<ASTNode> b)
-        : init(std::move(i)), condition(std::move(cond)), increment(std::move(inc)), body(std::move(b)) {}
-
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) override {
-        init->parentID = pID;
-        condition->parentID = pID;
-        increment->parentID = pID;
-        body->parentID = pID;
-    }
+    ASTNode* init;
+    ASTNode* condition;
+    ASTNode* increment;
+    ASTNode* body;
+
+    ForStatementNode(ASTNode* i, ASTNode* cond, ASTNode* inc, ASTNode* b)
+        : StatementNode(NodeKind::ForStatement), init(i), condition(cond), increment(inc), body(b) {}
+
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ForStatement; }
+
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
 };
 
 class ReturnStatementNode : public StatementNode {
 public:
-    UnqPtr<ASTNode> expression;
+    ASTNode* expression;
 
-    ReturnStatementNode(UnqPtr<ASTNode> expr) : expression(std::move(expr)) {}
+    ReturnStatementNode(ASTNode* expr) : StatementNode(NodeKind::ReturnStatement), expression(expr) {}
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) override {
-        expression->parentID = pID;
-    }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ReturnStatement; }
+
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
 };
 
 class PrintStatementNode : public StatementNode {
 public:
-    UnqPtr<ASTNode> exprList;
+    ASTNode* exprList;
 
-    PrintStatementNode(UnqPtr<ASTNode> el) : exprList(std::move(el)) {}
+    PrintStatementNode(ASTNode* el) : StatementNode(NodeKind::PrintStatement), exprList(el) {}
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) override {
-        exprList->parentID = pID;
-    }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::PrintStatement; }
+
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
 };
 
 class ExprListNode : public ASTNode {
 public:
-    std::vector<UnqPtr<ASTNode>> expressions;
+    std::vector<ASTNode*> expressions;
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) override {
-        for (auto& expr : expressions) expr->parentID = pID;
-    }
-    void AddExpression(UnqPtr<ASTNode> expr) {
-        expressions.push_back(std::move(expr));
+    ExprListNode() : ASTNode(NodeKind::ExprList) {}
+
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ExprList; }
+
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
+    void AddExpression(ASTNode* expr) {
+        expressions.push_back(expr);
     }
 };
 
 class CompoundStatementNode : public StatementNode {
 public:
-    std::vector<UnqPtr<ASTNode>> statements;
+    std::vector<ASTNode*> statements;
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) override {
-        for (auto& stmt : statements) stmt->parentID = pID;
-    }
-    void AddStatement(UnqPtr<ASTNode> statement) {
-        statements.push_back(std::move(statement));
+    CompoundStatementNode() : StatementNode(NodeKind::CompoundStatement) {}
+
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::CompoundStatement; }
+
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
+    void AddStatement(ASTNode* statement) {
+        statements.push_back(statement);
     }
 };
 
 class RelationalNode : public BinaryOperationNode {
 public:
-    RelationalNode(UnqPtr<ASTNode> left, const Token& op, UnqPtr<ASTNode> right)
-        : BinaryOperationNode(std::move(left), op, std::move(right)) {}
+    RelationalNode(ASTNode* left, const Token& op, ASTNode* right)
+        : BinaryOperationNode(NodeKind::Relational, left, op, right) {}
+
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Relational; }
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
 };
 
 class EqualityNode : public BinaryOperationNode {
 public:
-    EqualityNode(UnqPtr<ASTNode> left, const Token& op, UnqPtr<ASTNode> right)
-        : BinaryOperationNode(std::move(left), op, std::move(right)) {}
+    EqualityNode(ASTNode* left, const Token& op, ASTNode* right)
+        : BinaryOperationNode(NodeKind::Equality, left, op, right) {}
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Equality; }
+
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
 };
 
 class LogicalOrNode : public BinaryOperationNode {
 public:
-    LogicalOrNode(UnqPtr<ASTNode> l, const Token& o, UnqPtr<ASTNode> r)
-        : BinaryOperationNode(std::move(l), o, std::move(r)) {}
+    LogicalOrNode(ASTNode* l, const Token& o, ASTNode* r)
+        : BinaryOperationNode(NodeKind::LogicalOr, l, o, r) {}
+
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::LogicalOr; }
 
-    void Accept(ASTNodeVisitor& visitor) override { visitor.Visit(*this); }
+    void Accept(ASTNodeVisitor& visitor) override { VisitStackSafe(visitor, *this); }
 };
 
 class LogicalAndNode : public BinaryOperationNode {
 public:
-    LogicalAndNode(UnqPtr<ASTNode> l, const Token& o, UnqPtr<ASTNode> r)
-        : BinaryOperationNode(std::move(l), o, std::move(r)) {}
+    LogicalAndNode(ASTNode* l, const Token& o, ASTNode* r)
+        : BinaryOperationNode(NodeKind::LogicalAnd, l, o, r) {}
 
-    void Accept(ASTNodeVisitor& visitor) override { visitor.Visit(*this); }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::LogicalAnd; }
+
+    void Accept(ASTNodeVisitor& visitor) override { VisitStackSafe(visitor, *this); }
 };
 
 class ExpressionStatementNode : public StatementNode {
 public:
-    UnqPtr<ASTNode> expression;  // opcional 
+    ASTNode* expression;  // opcional 
 
-    ExpressionStatementNode(UnqPtr<ASTNode> expr = nullptr) 
-        : expression(std::move(expr)) {}
+    ExpressionStatementNode(ASTNode* expr = nullptr) 
+        : StatementNode(NodeKind::ExpressionStatement), expression(expr) {}
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) override {
-        if (expression) expression->parentID = pID;
-    }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ExpressionStatement; }
+
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
 };
 
 class ParamListNode : public ASTNode {
 public:
-    std::vector<UnqPtr<ParamNode>> parameters;
+    std::vector<ParamNode*> parameters;
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) override {
-        for (auto& param : parameters) param->parentID = pID;
-    }
-    void AddParameter(UnqPtr<ParamNode> param) {
-        parameters.push_back(std::move(param));
+    ParamListNode() : ASTNode(NodeKind::ParamList) {}
+
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::ParamList; }
+
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
+    void AddParameter(ParamNode* param) {
+        parameters.push_back(param);
     }
 };
 
 class FunctionCallNode : public ASTNode {
     public:
-        UnqPtr<IdentifierNode> functionName;
-        UnqPtr<ExprListNode> arguments;
+        IdentifierNode* functionName;
+        ExprListNode* arguments;
 
-        FunctionCallNode(UnqPtr<IdentifierNode> fnName, UnqPtr<ExprListNode> args)
-            : functionName(std::move(fnName)), arguments(std::move(args)) {}
+        FunctionCallNode(IdentifierNode* fnName, ExprListNode* args)
+            : ASTNode(NodeKind::FunctionCall), functionName(fnName), arguments(args) {}
         
-        void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-        void SetChildrenPrintID(const std::string& pID) override {
-            functionName->parentID = pID;
-            if (arguments) {
-                arguments->parentID = pID;
-            }
-        }
+        static bool classof(const ASTNode* node) { return node->kind == NodeKind::FunctionCall; }
+
+        void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
 };
 
 class IndexingNode : public ASTNode {
 public:
-    UnqPtr<ASTNode> base;
-    UnqPtr<ASTNode> index;
+    ASTNode* base;
+    ASTNode* index;
 
-    IndexingNode(UnqPtr<ASTNode> b, UnqPtr<ASTNode> i)
-        : base(std::move(b)), index(std::move(i)) {}
+    IndexingNode(ASTNode* b, ASTNode* i)
+        : ASTNode(NodeKind::Indexing), base(b), index(i) {}
 
-    void Accept(ASTNodeVisitor& v) override { v.Visit(*this); }
-    void SetChildrenPrintID(const std::string& pID) override {
-        base->parentID = pID;
-        index->parentID = pID;
-    }
+    static bool classof(const ASTNode* node) { return node->kind == NodeKind::Indexing; }
+
+    void Accept(ASTNodeVisitor& v) override { VisitStackSafe(v, *this); }
 };
 
+// Los nodos sin listas no necesitan destructor: el ASTContext solo libera su arena.
+static_assert(std::is_trivially_destructible_v<BinaryOperationNode> && std::is_trivially_destructible_v<IdentifierNode>,
+              "los nodos sin listas no deben tener destructor");
 
 #endif
 
@@ -0,0 +1,62 @@
+#ifndef AST_CONTEXT_H
+#define AST_CONTEXT_H
+
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../utils/arena.h"
+
+// Dueño de la memoria de un AST. Los nodos se construyen dentro de un arena y
+// se liberan todos juntos cuando se destruye el contexto; entre ellos solo hay
+// punteros sin propiedad. La mayoría de los nodos no necesita destructor: solo
+// los que guardan listas o un cuerpo aplazado se anotan al crearlos.
+class ASTContext {
+public:
+    ASTContext() = default;
+    ~ASTContext() { Reset(); }
+    ASTContext(const ASTContext&) = delete;
+    ASTContext& operator=(const ASTContext&) = delete;
+
+    template<typename T, typename... Args>
+    T* Create(Args&&... args) {
+        T* node = new (arena.allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            cleanups.push_back(Cleanup{node, [](void* object) { static_cast<T*>(object)->~T(); }});
+        }
+        return node;
+    }
+
+    // Se queda con los nodos de `other`, que queda vacío. Así junta
+    // Parser::parseParallel() los árboles de sus hilos.
+    void Adopt(ASTContext& other) {
+        adopted.push_back(std::move(other.arena));
+        for (BumpArena& arena : other.adopted) adopted.push_back(std::move(arena));
+        cleanups.insert(cleanups.end(), other.cleanups.begin(), other.cleanups.end());
+        other.arena = BumpArena(BLOCK_SIZE);
+        other.adopted.clear();
+        other.cleanups.clear();
+    }
+
+    // Libera todos los nodos; el contexto puede volver a usarse.
+    void Reset() {
+        for (auto it = cleanups.rbegin(); it != cleanups.rend(); ++it) it->destroy(it->object);
+        cleanups.clear();
+        arena.clear();
+        adopted.clear();
+    }
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    struct Cleanup {
+        void* object;
+        void (*destroy)(void*);
+    };
+
+    BumpArena arena{BLOCK_SIZE};
+    std::vector<BumpArena> adopted;
+    std::vector<Cleanup> cleanups;
+};
+
+#endif
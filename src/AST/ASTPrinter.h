@@ -1,8 +1,9 @@
 #include "ASTVisitor.h"
 #include "AST.h"
+#include "StaticVisitor.h"
 #include "../scanner/token.h"
 
-class ASTPrinter : public ASTNodeVisitor {
+class ASTPrinter final : public ASTNodeVisitor, public StaticVisitor<ASTPrinter> {
 private:
     int indentation = 0;
 
@@ -16,7 +17,7 @@ public:
         std::cout << "ProgramNode\n";
         Indent();
         for (const auto& decl : node.declarations) {
-            decl->Accept(*this);
+            Dispatch(*decl);
         }
         Dedent();
     }
@@ -32,7 +33,7 @@ public:
         if (node.expression) {
             Indent();
             std::cout << "Assigned Expression:\n";
-            node.expression->Accept(*this);
+            Dispatch(*node.expression);
             Dedent();
         }
     }
@@ -43,10 +44,10 @@ public:
         Indent();
         std::cout << "Parameters:\n";
         for (const auto& param : node.parameters) {
-            param->Accept(*this);
+            Dispatch(*param);
         }
         std::cout << "Function Body:\n";
-        if (node.body) node.body->Accept(*this);
+        if (ASTNode* body = node.Body()) Dispatch(*body);
         Dedent();
     }
 
@@ -61,7 +62,7 @@ public:
         std::cout << "ParamListNode\n";
         Indent();
         for (const auto& param : node.parameters) {
-            param->Accept(*this);
+            Dispatch(*param);
         }
         Dedent();
     }
@@ -77,9 +78,9 @@ public:
         std::cout << "AssignmentNode: " << node.op.value << "\n";
         Indent();
         std::cout << "Left Side:\n";
-        node.left->Accept(*this);
+        Dispatch(*node.left);
         std::cout << "Right Side:\n";
-        node.right->Accept(*this);
+        Dispatch(*node.right);
         Dedent();
     }
 
@@ -88,9 +89,9 @@ public:
         std::cout << "BinaryOperationNode: " << node.op.value << "\n";
         Indent();
         std::cout << "Left Operand:\n";
-        node.left->Accept(*this);
+        Dispatch(*node.left);
         std::cout << "Right Operand:\n";
-        node.right->Accept(*this);
+        Dispatch(*node.right);
         Dedent();
     }
 
@@ -98,18 +99,18 @@ public:
         PrintIndent();
         std::cout << "UnaryOperationNode: " << node.op.value << "\n";
         Indent();
-        node.expr->Accept(*this);
+        Dispatch(*node.expr);
         Dedent();
     }
 
     void Visit(LiteralNode& node) override {
         PrintIndent();
-        std::cout << "LiteralNode: " << node.literal.value << " (" << tokenTypeMap.at(node.literal.type) << ")\n";
+        std::cout << "LiteralNode: " << node.literal.value << " (" << tokenTypeName(node.literal.type) << ")\n";
     }
 
     void Visit(IdentifierNode& node) override {
         PrintIndent();
-        std::cout << "IdentifierNode: " << node.identifier.value << " (" << tokenTypeMap.at(node.identifier.type) << ")\n";
+        std::cout << "IdentifierNode: " << node.identifier.value << " (" << tokenTypeName(node.identifier.type) << ")\n";
     }
 
     void Visit(TypeNode& node) override {
@@ -122,9 +123,9 @@ public:
         std::cout << "RelationalNode: " << node.op.value << "\n";
         Indent();
         std::cout << "Left Operand:\n";
-        node.left->Accept(*this);
+        Dispatch(*node.left);
         std::cout << "Right Operand:\n";
-        node.right->Accept(*this);
+        Dispatch(*node.right);
         Dedent();
     }
 
@@ -133,9 +134,9 @@ public:
         std::cout << "EqualityNode: " << node.op.value << "\n";
         Indent();
         std::cout << "Left Operand:\n";
-        node.left->Accept(*this);
+        Dispatch(*node.left);
         std::cout << "Right Operand:\n";
-        node.right->Accept(*this);
+        Dispatch(*node.right);
         Dedent();
     }
 
@@ -144,9 +145,9 @@ public:
         std::cout << "LogicalOrNode: " << node.op.value << " (||)\n";
         Indent();
         std::cout << "Left Operand:\n";
-        node.left->Accept(*this);
+        Dispatch(*node.left);
         std::cout << "Right Operand:\n";
-        node.right->Accept(*this);
+        Dispatch(*node.right);
         Dedent();
     }
 
@@ -155,9 +156,9 @@ public:
         std::cout << "LogicalAndNode: " << node.op.value << " (&&)\n";
         Indent();
         std::cout << "Left Operand:\n";
-        node.left->Accept(*this);
+        Dispatch(*node.left);
         std::cout << "Right Operand:\n";
-        node.right->Accept(*this);
+        Dispatch(*node.right);
         Dedent();
     }
 
@@ -171,12 +172,12 @@ public:
         std::cout << "IfStatementNode\n";
         Indent();
         std::cout << "Condition:\n";
-        node.condition->Accept(*this);
+        Dispatch(*node.condition);
         std::cout << "If Body:\n";
-        node.ifBody->Accept(*this);
+        Dispatch(*node.ifBody);
         if (node.elseBody) {
             std::cout << "Else Body:\n";
-            node.elseBody->Accept(*this);
+            Dispatch(*node.elseBody);
         }
         Dedent();
     }
@@ -186,13 +187,13 @@ public:
         std::cout << "ForStatementNode\n";
         Indent();
         std::cout << "Initialization:\n";
-        node.init->Accept(*this);
+        Dispatch(*node.init);
         std::cout << "Condition:\n";
-        node.condition->Accept(*this);
+        Dispatch(*node.condition);
         std::cout << "Increment:\n";
-        node.increment->Accept(*this);
+        Dispatch(*node.increment);
         std::cout << "Body:\n";
-        node.body->Accept(*this);
+        Dispatch(*node.body);
         Dedent();
     }
 
@@ -200,7 +201,7 @@ public:
         PrintIndent();
         std::cout << "ReturnStatementNode\n";
         Indent();
-        node.expression->Accept(*this);
+        Dispatch(*node.expression);
         Dedent();
     }
 
@@ -208,7 +209,7 @@ public:
         PrintIndent();
         std::cout << "PrintStatementNode\n";
         Indent();
-        node.exprList->Accept(*this);
+        Dispatch(*node.exprList);
         Dedent();
     }
 
@@ -216,7 +217,7 @@ public:
         PrintIndent();
         std::cout << "ExpressionStatementNode\n";
         Indent();
-        node.expression->Accept(*this);
+        Dispatch(*node.expression);
         Dedent();
     }
 
@@ -225,7 +226,7 @@ public:
         std::cout << "CompoundStatementNode\n";
         Indent();
         for (const auto& stmt : node.statements) {
-            stmt->Accept(*this);
+            Dispatch(*stmt);
         }
         Dedent();
     }
@@ -235,7 +236,7 @@ public:
         std::cout << "ExprListNode\n";
         Indent();
         for (const auto& expr : node.expressions) {
-            expr->Accept(*this);
+            Dispatch(*expr);
         }
         Dedent();
     }
@@ -249,7 +250,7 @@ public:
         Indent();
         if (node.arguments) {
             for (const auto& arg : node.arguments->expressions) {
-                arg->Accept(*this);
+                Dispatch(*arg);
             }
         }
         Dedent();
@@ -264,13 +265,13 @@ public:
         PrintIndent();
         std::cout << "Base:\n";
         Indent();
-        node.base->Accept(*this); // Visitar el nodo base
+        Dispatch(*node.base); // Visitar el nodo base
         Dedent();
 
         PrintIndent();
         std::cout << "Index:\n";
         Indent();
-        node.index->Accept(*this); // Visitar el nodo índice
+        Dispatch(*node.index); // Visitar el nodo índice
         Dedent();
         
         Dedent();
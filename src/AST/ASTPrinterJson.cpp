@@ -28,10 +28,13 @@ std::string ASTPrinterJson::EscapeString(const std::string& str) const {
     return "\"" + escaped + "\"";
 }
 
-void ASTPrinterJson::WriteNode(const std::string& type, const std::string& content, const ASTNode* node, const std::string& parentID) {
-    const std::string nodeID = Util::GenerateID(node, type.c_str());
+void ASTPrinterJson::WriteNode(const std::string& type, const std::string& content, const ASTNode* node, std::string_view parentID) {
+    WriteNode(type, content, Util::GenerateID(node, type.c_str()), parentID);
+}
+
+void ASTPrinterJson::WriteNode(std::string_view type, const std::string& content, const std::string& nodeID, std::string_view parentID) {
     out << "{ \"id\": \"" << nodeID << "\", \"parent\": \"" << parentID << "\", \"type\": " 
-        << EscapeString(type) << ", \"content\": " << EscapeString(content) << " },\n";
+        << EscapeString(std::string(type)) << ", \"content\": " << EscapeString(content) << " },\n";
     config.push_back(nodeID);
 }
 
@@ -53,9 +56,54 @@ void ASTPrinterJson::GenerateJSONFooter() {
 
 void ASTPrinterJson::PrintAST(ProgramNode* root) {
     if (!root) return;
-    std::string rootID = GenerateJSONHeader(root, "ROOT");
-    root->SetChildrenPrintID(rootID);
-    root->Accept(*this);
+    GenerateJSONHeader(root, "ROOT");
+    Dispatch(*root);
+}
+
+void ASTPrinterJson::Print(const FlatAST& ast) {
+    // Ancestros del registro actual: su ID y dónde termina su subárbol.
+    std::vector<std::pair<std::string, uint32_t>> open;
+    for (uint32_t i = 0; i < ast.Size(); i++) {
+        const FlatNode& node = ast[i];
+        while (!open.empty() && open.back().second <= i) open.pop_back();
+        if (node.kind == FlatKind::Empty) continue;
+
+        std::string content;
+        switch (node.kind) {
+            case FlatKind::Program: content = "Program Start"; break;
+            case FlatKind::VarDeclaration:
+            case FlatKind::FunctionDeclaration:
+            case FlatKind::Param:
+                content = std::string(ast.TokenValue(node.token)) + "(" + std::string(ast.TokenValue(node.payload)) + ")";
+                break;
+            case FlatKind::ParamList: content = "Parameter List"; break;
+            case FlatKind::Assignment: content = "Assignment"; break;
+            case FlatKind::LogicalOr: content = "||"; break;
+            case FlatKind::LogicalAnd: content = "&&"; break;
+            case FlatKind::IfStatement: content = "If Statement"; break;
+            case FlatKind::ForStatement: content = "For Loop"; break;
+            case FlatKind::ReturnStatement: content = "Return"; break;
+            case FlatKind::PrintStatement: content = "Print Statement"; break;
+            case FlatKind::ExpressionStatement: content = "Expression Statement"; break;
+            case FlatKind::CompoundStatement: content = "Compound Statement"; break;
+            case FlatKind::ExprList: content = "Expression List"; break;
+            case FlatKind::Indexing: content = "Indexing"; break;
+            default: content = std::string(ast.TokenValue(node.token)); break;
+        }
+
+        std::string nodeID = std::string(flatKindName(node.kind)) + std::to_string(i);
+        std::string parent = open.empty() ? std::string() : open.back().first;
+        WriteNode(flatKindName(node.kind), content, nodeID, parent);
+        // Como en Visit(ParamListNode&), los parámetros cuelgan del padre de la lista.
+        open.emplace_back(node.kind == FlatKind::ParamList ? std::move(parent) : std::move(nodeID), node.end);
+    }
+}
+
+void ASTPrinterJson::VisitChild(ASTNode& child, const std::string& id) {
+    std::string saved = std::move(parentID);
+    parentID = id;
+    Dispatch(child);
+    parentID = std::move(saved);
 }
 
 void ASTPrinterJson::Visit(ProgramNode& node) {
@@ -63,216 +111,183 @@ void ASTPrinterJson::Visit(ProgramNode& node) {
     WriteNode("ProgramNode", "Program Start", &node, "");
     
     for (const auto& decl : node.declarations) {
-        decl->parentID = programNodeID;
-        decl->Accept(*this);
+        VisitChild(*decl, programNodeID);
     }
 }
 
 void ASTPrinterJson::Visit(DeclarationNode& node) {
-    WriteNode("DeclarationNode", "Declaration", &node, node.parentID);
+    WriteNode("DeclarationNode", "Declaration", &node, parentID);
 }
 
 void ASTPrinterJson::Visit(VarDeclarationNode& node) {
     const std::string varDeclID = Util::GenerateID(&node, "VarDeclarationNode");
-    WriteNode("VarDeclarationNode", node.identifier.value + "(" + node.type.value + ")", &node, node.parentID);
+    WriteNode("VarDeclarationNode", std::string(node.identifier.value) + "(" + std::string(node.type.value) + ")", &node, parentID);
 
     if (node.expression) {
-        node.expression->parentID = varDeclID;
-        node.expression->Accept(*this);
+        VisitChild(*node.expression, varDeclID);
     }
 }
 
 void ASTPrinterJson::Visit(FunctionDeclarationNode& node) {
     const std::string functionNodeID = Util::GenerateID(&node, "FunctionDeclarationNode");
-    WriteNode("FunctionDeclarationNode", node.functionName.value + "(" + node.returnType.value + ")", &node, node.parentID);
+    WriteNode("FunctionDeclarationNode", std::string(node.functionName.value) + "(" + std::string(node.returnType.value) + ")", &node, parentID);
 
     for (const auto& param : node.parameters) {
-        param->parentID = functionNodeID;
-        param->Accept(*this);
+        VisitChild(*param, functionNodeID);
     }
 
-    if (node.body) {
-        node.body->parentID = functionNodeID;
-        node.body->Accept(*this);
+    if (ASTNode* body = node.Body()) {
+        VisitChild(*body, functionNodeID);
     }
 }
 
 void ASTPrinterJson::Visit(ParamNode& node) {
-    WriteNode("ParamNode", node.identifier.value + "(" + node.type.value + ")", &node, node.parentID);
+    WriteNode("ParamNode", std::string(node.identifier.value) + "(" + std::string(node.type.value) + ")", &node, parentID);
 }
 
 void ASTPrinterJson::Visit(ParamListNode& node) {
-    WriteNode("ParamListNode", "Parameter List", &node, node.parentID);
+    WriteNode("ParamListNode", "Parameter List", &node, parentID);
     for (const auto& param : node.parameters) {
-        param->parentID = node.parentID;
-        param->Accept(*this);
+        Dispatch(*param);
     }
 }
 
 void ASTPrinterJson::Visit(ExpressionNode& node) {
-    WriteNode("ExpressionNode", "Expression", &node, node.parentID);
+    WriteNode("ExpressionNode", "Expression", &node, parentID);
 }
 
 void ASTPrinterJson::Visit(AssignmentNode& node) {
     const std::string assignID = Util::GenerateID(&node, "AssignmentNode");
-    WriteNode("AssignmentNode", "Assignment", &node, node.parentID);
-    node.left->parentID = assignID;
-    node.left->Accept(*this);
-    node.right->parentID = assignID;
-    node.right->Accept(*this);
+    WriteNode("AssignmentNode", "Assignment", &node, parentID);
+    VisitChild(*node.left, assignID);
+    VisitChild(*node.right, assignID);
 }
 
 void ASTPrinterJson::Visit(BinaryOperationNode& node) {
     const std::string binOpID = Util::GenerateID(&node, "BinaryOperationNode");
-    WriteNode("BinaryOperationNode", node.op.value, &node, node.parentID);
-    node.left->parentID = binOpID;
-    node.left->Accept(*this);
-    node.right->parentID = binOpID;
-    node.right->Accept(*this);
+    WriteNode("BinaryOperationNode", std::string(node.op.value), &node, parentID);
+    VisitChild(*node.left, binOpID);
+    VisitChild(*node.right, binOpID);
 }
 
 void ASTPrinterJson::Visit(UnaryOperationNode& node) {
     const std::string unaryOpID = Util::GenerateID(&node, "UnaryOperationNode");
-    WriteNode("UnaryOperationNode", node.op.value, &node, node.parentID);
-    node.expr->parentID = unaryOpID;
-    node.expr->Accept(*this);
+    WriteNode("UnaryOperationNode", std::string(node.op.value), &node, parentID);
+    VisitChild(*node.expr, unaryOpID);
 }
 
 void ASTPrinterJson::Visit(LiteralNode& node) {
-    WriteNode("LiteralNode", node.literal.value, &node, node.parentID);
+    WriteNode("LiteralNode", std::string(node.literal.value), &node, parentID);
 }
 
 void ASTPrinterJson::Visit(IdentifierNode& node) {
-    WriteNode("IdentifierNode", node.identifier.value, &node, node.parentID);
+    WriteNode("IdentifierNode", std::string(node.identifier.value), &node, parentID);
 }
 
 void ASTPrinterJson::Visit(TypeNode& node) {
-    WriteNode("TypeNode", node.type.value, &node, node.parentID);
+    WriteNode("TypeNode", std::string(node.type.value), &node, parentID);
 }
 
 void ASTPrinterJson::Visit(RelationalNode& node) {
     const std::string relOpID = Util::GenerateID(&node, "RelationalNode");
-    WriteNode("RelationalNode", node.op.value, &node, node.parentID);
-    node.left->parentID = relOpID;
-    node.left->Accept(*this);
-    node.right->parentID = relOpID;
-    node.right->Accept(*this);
+    WriteNode("RelationalNode", std::string(node.op.value), &node, parentID);
+    VisitChild(*node.left, relOpID);
+    VisitChild(*node.right, relOpID);
 }
 
 void ASTPrinterJson::Visit(EqualityNode& node) {
     const std::string eqOpID = Util::GenerateID(&node, "EqualityNode");
-    WriteNode("EqualityNode", node.op.value, &node, node.parentID);
-    node.left->parentID = eqOpID;
-    node.left->Accept(*this);
-    node.right->parentID = eqOpID;
-    node.right->Accept(*this);
+    WriteNode("EqualityNode", std::string(node.op.value), &node, parentID);
+    VisitChild(*node.left, eqOpID);
+    VisitChild(*node.right, eqOpID);
 }
 
 void ASTPrinterJson::Visit(LogicalOrNode& node) {
     const std::string orNodeID = Util::GenerateID(&node, "LogicalOrNode");
-    WriteNode("LogicalOrNode", "||", &node, node.parentID);
-    node.left->parentID = orNodeID;
-    node.left->Accept(*this);
-    node.right->parentID = orNodeID;
-    node.right->Accept(*this);
+    WriteNode("LogicalOrNode", "||", &node, parentID);
+    VisitChild(*node.left, orNodeID);
+    VisitChild(*node.right, orNodeID);
 }
 
 void ASTPrinterJson::Visit(LogicalAndNode& node) {
     const std::string andNodeID = Util::GenerateID(&node, "LogicalAndNode");
-    WriteNode("LogicalAndNode", "&&", &node, node.parentID);
-    node.left->parentID = andNodeID;
-    node.left->Accept(*this);
-    node.right->parentID = andNodeID;
-    node.right->Accept(*this);
+    WriteNode("LogicalAndNode", "&&", &node, parentID);
+    VisitChild(*node.left, andNodeID);
+    VisitChild(*node.right, andNodeID);
 }
 
 void ASTPrinterJson::Visit(StatementNode& node) {
-    WriteNode("StatementNode", "Statement", &node, node.parentID);
+    WriteNode("StatementNode", "Statement", &node, parentID);
 }
 
 void ASTPrinterJson::Visit(IfStatementNode& node) {
     const std::string ifNodeID = Util::GenerateID(&node, "IfStatementNode");
-    WriteNode("IfStatementNode", "If Statement", &node, node.parentID);
-    node.condition->parentID = ifNodeID;
-    node.condition->Accept(*this);
-    node.ifBody->parentID = ifNodeID;
-    node.ifBody->Accept(*this);
+    WriteNode("IfStatementNode", "If Statement", &node, parentID);
+    VisitChild(*node.condition, ifNodeID);
+    VisitChild(*node.ifBody, ifNodeID);
     if (node.elseBody) {
-        node.elseBody->parentID = ifNodeID;
-        node.elseBody->Accept(*this);
+        VisitChild(*node.elseBody, ifNodeID);
     }
 }
 
 void ASTPrinterJson::Visit(ForStatementNode& node) {
     const std::string forNodeID = Util::GenerateID(&node, "ForStatementNode");
-    WriteNode("ForStatementNode", "For Loop", &node, node.parentID);
-    node.init->parentID = forNodeID;
-    node.init->Accept(*this);
-    node.condition->parentID = forNodeID;
-    node.condition->Accept(*this);
-    node.increment->parentID = forNodeID;
-    node.increment->Accept(*this);
-    node.body->parentID = forNodeID;
-    node.body->Accept(*this);
+    WriteNode("ForStatementNode", "For Loop", &node, parentID);
+    VisitChild(*node.init, forNodeID);
+    VisitChild(*node.condition, forNodeID);
+    VisitChild(*node.increment, forNodeID);
+    VisitChild(*node.body, forNodeID);
 }
 
 void ASTPrinterJson::Visit(ReturnStatementNode& node) {
     const std::string returnID = Util::GenerateID(&node, "ReturnStatementNode");
-    WriteNode("ReturnStatementNode", "Return", &node, node.parentID);
+    WriteNode("ReturnStatementNode", "Return", &node, parentID);
     if (node.expression) {
-        node.expression->parentID = returnID;
-        node.expression->Accept(*this);
+        VisitChild(*node.expression, returnID);
     }
 }
 
 void ASTPrinterJson::Visit(PrintStatementNode& node) {
     const std::string printID = Util::GenerateID(&node, "PrintStatementNode");
-    WriteNode("PrintStatementNode", "Print Statement", &node, node.parentID);
-    node.exprList->parentID = printID;
-    node.exprList->Accept(*this);
+    WriteNode("PrintStatementNode", "Print Statement", &node, parentID);
+    VisitChild(*node.exprList, printID);
 }
 
 void ASTPrinterJson::Visit(ExpressionStatementNode& node) {
     const std::string ExpressionStatementNodeID = Util::GenerateID(&node, "ExpressionStatementNode");
-    WriteNode("ExpressionStatementNode", "Expression Statement", &node, node.parentID);
-    node.expression->parentID = ExpressionStatementNodeID;
-    node.expression->Accept(*this);
+    WriteNode("ExpressionStatementNode", "Expression Statement", &node, parentID);
+    VisitChild(*node.expression, ExpressionStatementNodeID);
 }
 
 void ASTPrinterJson::Visit(CompoundStatementNode& node) {
     const std::string CompoundStatementNodeID = Util::GenerateID(&node, "CompoundStatementNode");
-    WriteNode("CompoundStatementNode", "Compound Statement", &node, node.parentID);
+    WriteNode("CompoundStatementNode", "Compound Statement", &node, parentID);
     for (const auto& stmt : node.statements) {
-        stmt->parentID = CompoundStatementNodeID;
-        stmt->Accept(*this);
+        VisitChild(*stmt, CompoundStatementNodeID);
     }
 }
 
 void ASTPrinterJson::Visit(ExprListNode& node) {
     const std::string ExprListNodeID = Util::GenerateID(&node, "ExprListNode");
-    WriteNode("ExprListNode", "Expression List", &node, node.parentID);
+    WriteNode("ExprListNode", "Expression List", &node, parentID);
     for (const auto& expr : node.expressions) {
-        expr->parentID = ExprListNodeID;
-        expr->Accept(*this);
+        VisitChild(*expr, ExprListNodeID);
     }
 }
 
 void ASTPrinterJson::Visit(FunctionCallNode& node) {
     const std::string funcCallID = Util::GenerateID(&node, "FunctionCallNode");
-    WriteNode("FunctionCallNode", node.functionName->identifier.value, &node, node.parentID);
+    WriteNode("FunctionCallNode", std::string(node.functionName->identifier.value), &node, parentID);
     if (node.arguments) {
         for (const auto& arg : node.arguments->expressions) {
-            arg->parentID = funcCallID;
-            arg->Accept(*this);
+            VisitChild(*arg, funcCallID);
         }
     }
 }
 
 void ASTPrinterJson::Visit(IndexingNode& node) {
     const std::string indexNodeID = Util::GenerateID(&node, "IndexingNode");
-    WriteNode("IndexingNode", "Indexing", &node, node.parentID);
-    node.base->parentID = indexNodeID;
-    node.base->Accept(*this);
-    node.index->parentID = indexNodeID;
-    node.index->Accept(*this);
+    WriteNode("IndexingNode", "Indexing", &node, parentID);
+    VisitChild(*node.base, indexNodeID);
+    VisitChild(*node.index, indexNodeID);
 }
@@ -3,27 +3,39 @@
 
 #include <vector>
 #include <fstream>
+#include <string_view>
 #include <cassert>
 #include "ASTVisitor.h"
 #include "AST.h"
+#include "FlatAST.h"
+#include "StaticVisitor.h"
 #include "../scanner/token.h"
 
-class ASTPrinterJson : public ASTNodeVisitor {
+class ASTPrinterJson final : public ASTNodeVisitor, public StaticVisitor<ASTPrinterJson> {
 private:
     std::vector<std::string> config;
     std::ofstream out;
     int nodeId;
+    // ID del padre del nodo que se está escribiendo; VisitChild() lo cambia
+    // mientras visita a un hijo.
+    std::string parentID;
 
     std::string EscapeString(const std::string& str) const;
-    void WriteNode(const std::string& type, const std::string& content, const ASTNode* node, const std::string& parentID);
+    void WriteNode(const std::string& type, const std::string& content, const ASTNode* node, std::string_view parentID);
+    void WriteNode(std::string_view type, const std::string& content, const std::string& nodeID, std::string_view parentID);
     std::string GenerateJSONHeader(const ASTNode* root, const char* rootID);
     void GenerateJSONFooter();
+    void VisitChild(ASTNode& child, const std::string& id);
 
 public:
     ASTPrinterJson(const std::string& filename);
     ~ASTPrinterJson();
 
     void PrintAST(ProgramNode* root);
+    // Escribe lo mismo que Dispatch() sobre el ProgramNode del que se
+    // construyó `ast`, pero recorriendo el arreglo en un solo bucle. Los IDs
+    // usan el índice del registro en vez de la dirección del nodo.
+    void Print(const FlatAST& ast);
 
     void Visit(ProgramNode& node) override;
     void Visit(DeclarationNode& node) override;
@@ -0,0 +1,191 @@
+#include "FlatAST.h"
+#include "StaticVisitor.h"
+#include <string>
+
+namespace {
+
+// Recorre el árbol de punteros y va agregando sus nodos en preorden.
+class FlatBuilder final : public ASTNodeVisitor, public StaticVisitor<FlatBuilder> {
+public:
+    FlatBuilder(const TokenBuffer& tokens, std::vector<FlatNode>& nodes) : tokens(tokens), nodes(nodes) {}
+
+    bool failed = false;
+
+    void Visit(ProgramNode& node) override {
+        uint32_t index = Open(FlatKind::Program, FlatAST::NO_TOKEN, static_cast<uint32_t>(node.declarations.size()));
+        for (ASTNode* decl : node.declarations) Dispatch(*decl);
+        Close(index);
+    }
+
+    void Visit(DeclarationNode& node) override {}
+
+    void Visit(VarDeclarationNode& node) override {
+        uint32_t index = Open(FlatKind::VarDeclaration, IndexOf(node.identifier), IndexOf(node.type));
+        Child(node.expression);
+        Close(index);
+    }
+
+    void Visit(FunctionDeclarationNode& node) override {
+        uint32_t index = Open(FlatKind::FunctionDeclaration, IndexOf(node.functionName), IndexOf(node.returnType));
+        for (ParamNode* param : node.parameters) Dispatch(*param);
+        Child(node.Body());
+        Close(index);
+    }
+
+    void Visit(ParamNode& node) override {
+        Close(Open(FlatKind::Param, IndexOf(node.identifier), IndexOf(node.type)));
+    }
+
+    void Visit(ParamListNode& node) override {
+        uint32_t index = Open(FlatKind::ParamList, FlatAST::NO_TOKEN, static_cast<uint32_t>(node.parameters.size()));
+        for (ParamNode* param : node.parameters) Dispatch(*param);
+        Close(index);
+    }
+
+    void Visit(ExpressionNode& node) override {}
+
+    void Visit(AssignmentNode& node) override { Binary(FlatKind::Assignment, node.op, node.left, node.right); }
+    void Visit(BinaryOperationNode& node) override { Binary(FlatKind::BinaryOperation, node.op, node.left, node.right); }
+    void Visit(RelationalNode& node) override { Binary(FlatKind::Relational, node.op, node.left, node.right); }
+    void Visit(EqualityNode& node) override { Binary(FlatKind::Equality, node.op, node.left, node.right); }
+    void Visit(LogicalOrNode& node) override { Binary(FlatKind::LogicalOr, node.op, node.left, node.right); }
+    void Visit(LogicalAndNode& node) override { Binary(FlatKind::LogicalAnd, node.op, node.left, node.right); }
+
+    void Visit(UnaryOperationNode& node) override {
+        uint32_t index = Open(FlatKind::UnaryOperation, IndexOf(node.op));
+        Child(node.expr);
+        Close(index);
+    }
+
+    void Visit(LiteralNode& node) override { Close(Open(FlatKind::Literal, IndexOf(node.literal))); }
+    void Visit(IdentifierNode& node) override { Close(Open(FlatKind::Identifier, IndexOf(node.identifier))); }
+    void Visit(TypeNode& node) override { Close(Open(FlatKind::Type, IndexOf(node.type), node.isArray ? 1 : 0)); }
+
+    void Visit(StatementNode& node) override {}
+
+    void Visit(IfStatementNode& node) override {
+        uint32_t index = Open(FlatKind::IfStatement);
+        Child(node.condition);
+        Child(node.ifBody);
+        Child(node.elseBody);
+        Close(index);
+    }
+
+    void Visit(ForStatementNode& node) override {
+        uint32_t index = Open(FlatKind::ForStatement);
+        Child(node.init);
+        Child(node.condition);
+        Child(node.increment);
+        Child(node.body);
+        Close(index);
+    }
+
+    void Visit(ReturnStatementNode& node) override {
+        uint32_t index = Open(FlatKind::ReturnStatement);
+        Child(node.expression);
+        Close(index);
+    }
+
+    void Visit(PrintStatementNode& node) override {
+        uint32_t index = Open(FlatKind::PrintStatement);
+        Child(node.exprList);
+        Close(index);
+    }
+
+    void Visit(ExpressionStatementNode& node) override {
+        uint32_t index = Open(FlatKind::ExpressionStatement);
+        Child(node.expression);
+        Close(index);
+    }
+
+    void Visit(CompoundStatementNode& node) override {
+        uint32_t index = Open(FlatKind::CompoundStatement, FlatAST::NO_TOKEN, static_cast<uint32_t>(node.statements.size()));
+        for (ASTNode* stmt : node.statements) Dispatch(*stmt);
+        Close(index);
+    }
+
+    void Visit(ExprListNode& node) override {
+        uint32_t index = Open(FlatKind::ExprList, FlatAST::NO_TOKEN, static_cast<uint32_t>(node.expressions.size()));
+        for (ASTNode* expr : node.expressions) Dispatch(*expr);
+        Close(index);
+    }
+
+    // Los argumentos quedan como hijos directos de la llamada.
+    void Visit(FunctionCallNode& node) override {
+        uint32_t count = node.arguments ? static_cast<uint32_t>(node.arguments->expressions.size()) : 0;
+        uint32_t index = Open(FlatKind::FunctionCall, IndexOf(node.functionName->identifier), count);
+        if (node.arguments) {
+            for (ASTNode* arg : node.arguments->expressions) Dispatch(*arg);
+        }
+        Close(index);
+    }
+
+    void Visit(IndexingNode& node) override {
+        uint32_t index = Open(FlatKind::Indexing);
+        Child(node.base);
+        Child(node.index);
+        Close(index);
+    }
+
+private:
+    uint32_t Open(FlatKind kind, uint32_t token = FlatAST::NO_TOKEN, uint32_t payload = 0) {
+        nodes.push_back(FlatNode{kind, token, 0, payload});
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+    void Close(uint32_t index) { nodes[index].end = static_cast<uint32_t>(nodes.size()); }
+
+    void Child(ASTNode* child) {
+        if (child) {
+            Dispatch(*child);
+        } else {
+            Close(Open(FlatKind::Empty));
+        }
+    }
+
+    void Binary(FlatKind kind, const Token& op, ASTNode* left, ASTNode* right) {
+        uint32_t index = Open(kind, IndexOf(op));
+        Child(left);
+        Child(right);
+        Close(index);
+    }
+
+    // Los tokens del buffer están ordenados por offset.
+    uint32_t IndexOf(const Token& token) {
+        size_t low = 0;
+        size_t high = tokens.size();
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            if (tokens.offset(mid) < token.offset) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        if (token.file != &tokens.getFile() || low == tokens.size() ||
+            tokens.offset(low) != token.offset || tokens.kind(low) != token.type) {
+            if (!failed) {
+                LOG_ERROR("FlatAST: el token '" + std::string(token.value) + "' no pertenece al TokenBuffer");
+            }
+            failed = true;
+            return FlatAST::NO_TOKEN;
+        }
+        return static_cast<uint32_t>(low);
+    }
+
+    const TokenBuffer& tokens;
+    std::vector<FlatNode>& nodes;
+};
+
+}
+
+bool FlatAST::Build(ProgramNode& root) {
+    nodes.clear();
+    FlatBuilder builder(*tokens, nodes);
+    builder.Dispatch(root);
+    if (builder.failed) {
+        nodes.clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,130 @@
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "AST.h"
+#include "../scanner/tokenbuffer.h"
+
+// Copia plana de un AST: un arreglo de registros de 16 bytes en preorden,
+// sin punteros. Se construye a partir del árbol de clases de AST.h y lo
+// pueden recorrer pasadas que solo necesitan un bucle y un switch por tipo.
+// Como los registros solo guardan índices, el arreglo se puede copiar con
+// memcpy o escribir a disco tal cual, junto con su TokenBuffer.
+
+// Un valor por clase concreta de AST.h. Empty ocupa el lugar de un hijo
+// opcional que falta, para que cada hijo tenga siempre la misma posición.
+enum class FlatKind : uint8_t {
+    Empty,
+    Program,              // hijos: declaraciones; payload: cuántas
+    VarDeclaration,       // token: nombre; payload: token del tipo; hijo: valor inicial
+    FunctionDeclaration,  // token: nombre; payload: token del tipo; hijos: parámetros y cuerpo
+    Param,                // token: nombre; payload: token del tipo
+    ParamList,            // hijos: parámetros; payload: cuántos
+    Assignment,           // token: operador; hijos: izquierda, derecha
+    BinaryOperation,      // token: operador; hijos: izquierda, derecha
+    Relational,
+    Equality,
+    LogicalOr,
+    LogicalAnd,
+    UnaryOperation,       // token: operador; hijo: operando
+    Literal,              // token: el literal
+    Identifier,           // token: el identificador
+    Type,                 // token: el tipo; payload: 1 si es arreglo
+    IfStatement,          // hijos: condición, then, else
+    ForStatement,         // hijos: inicio, condición, incremento, cuerpo
+    ReturnStatement,      // hijo: expresión
+    PrintStatement,       // hijo: lista de expresiones
+    ExpressionStatement,  // hijo: expresión
+    CompoundStatement,    // hijos: sentencias; payload: cuántas
+    ExprList,             // hijos: expresiones; payload: cuántas
+    FunctionCall,         // token: nombre; hijos: argumentos; payload: cuántos
+    Indexing,             // hijos: base, índice
+};
+
+// Nombre de la clase de AST.h que representa cada FlatKind.
+inline constexpr std::string_view flatKindNames[] = {
+    "Empty",
+    "ProgramNode",
+    "VarDeclarationNode",
+    "FunctionDeclarationNode",
+    "ParamNode",
+    "ParamListNode",
+    "AssignmentNode",
+    "BinaryOperationNode",
+    "RelationalNode",
+    "EqualityNode",
+    "LogicalOrNode",
+    "LogicalAndNode",
+    "UnaryOperationNode",
+    "LiteralNode",
+    "IdentifierNode",
+    "TypeNode",
+    "IfStatementNode",
+    "ForStatementNode",
+    "ReturnStatementNode",
+    "PrintStatementNode",
+    "ExpressionStatementNode",
+    "CompoundStatementNode",
+    "ExprListNode",
+    "FunctionCallNode",
+    "IndexingNode",
+};
+static_assert(std::size(flatKindNames) == static_cast<size_t>(FlatKind::Indexing) + 1,
+              "flatKindNames debe tener un nombre por FlatKind");
+
+constexpr std::string_view flatKindName(FlatKind kind) {
+    return flatKindNames[static_cast<size_t>(kind)];
+}
+
+// El primer hijo de un nodo, si tiene, es el registro siguiente; `end` es
+// el índice que sigue a su subárbol, o sea su próximo hermano.
+struct FlatNode {
+    FlatKind kind;
+    uint32_t token;    // índice en el TokenBuffer, o FlatAST::NO_TOKEN
+    uint32_t end;
+    uint32_t payload;  // depende de kind, ver FlatKind
+};
+
+static_assert(sizeof(FlatNode) == 16, "FlatNode debe ocupar 16 bytes");
+static_assert(std::is_trivially_copyable_v<FlatNode>, "FlatNode se copia con memcpy");
+
+class FlatAST {
+public:
+    static constexpr uint32_t NO_TOKEN = UINT32_MAX;
+
+    // `tokens` tiene que ser el buffer del que se analizó el árbol.
+    explicit FlatAST(const TokenBuffer& tokens) : tokens(&tokens) {}
+
+    // Reemplaza el contenido por el árbol de `root`. Los cuerpos aplazados se
+    // analizan al llegar a ellos. Devuelve false si algún token del árbol no
+    // es de `tokens`, como las declaraciones que Parser::reparse() reutiliza
+    // de la versión anterior del archivo.
+    bool Build(ProgramNode& root);
+
+    uint32_t Size() const { return static_cast<uint32_t>(nodes.size()); }
+    const FlatNode& operator[](uint32_t index) const { return nodes[index]; }
+    const std::vector<FlatNode>& Nodes() const { return nodes; }
+    const TokenBuffer& Tokens() const { return *tokens; }
+
+    bool HasChildren(uint32_t index) const { return nodes[index].end > index + 1; }
+    uint32_t FirstChild(uint32_t index) const { return index + 1; }
+    uint32_t NextSibling(uint32_t index) const { return nodes[index].end; }
+    // El hijo número `n`, contando desde 0. Salta los n hermanos anteriores.
+    uint32_t Child(uint32_t index, uint32_t n) const {
+        uint32_t child = index + 1;
+        while (n-- > 0) child = nodes[child].end;
+        return child;
+    }
+
+    std::string_view TokenValue(uint32_t token) const { return tokens->value(token); }
+
+private:
+    const TokenBuffer* tokens;
+    std::vector<FlatNode> nodes;
+};
+
+#endif
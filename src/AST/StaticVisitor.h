@@ -0,0 +1,61 @@
+#ifndef STATIC_VISITOR_H
+#define STATIC_VISITOR_H
+
+#include "AST.h"
+#include "../utils/stack.h"
+
+// Despacho sin llamadas virtuales: Dispatch() mira el NodeKind del nodo y
+// llama directamente al Visit() de Derived que le corresponde. Si Derived es
+// final, el compilador puede expandir los Visit() dentro del switch y
+// optimizar la pasada entera de una vez. Los visitantes del árbol lo usan
+// para recorrer a los hijos; ASTNodeVisitor y Accept() siguen ahí para
+// quien visite el árbol desde fuera.
+template<typename Derived>
+class StaticVisitor {
+public:
+    void Dispatch(ASTNode& node) {
+        // Igual que VisitStackSafe(): en un árbol muy profundo la visita
+        // sigue en un segmento de pila nuevo.
+        if (Stack::isLow()) {
+            Stack::onNewSegment([&] { DispatchKind(node); });
+            return;
+        }
+        DispatchKind(node);
+    }
+
+protected:
+    ~StaticVisitor() = default;
+
+private:
+    void DispatchKind(ASTNode& node) {
+        Derived& self = static_cast<Derived&>(*this);
+        switch (node.kind) {
+            case NodeKind::Program: self.Visit(static_cast<ProgramNode&>(node)); return;
+            case NodeKind::VarDeclaration: self.Visit(static_cast<VarDeclarationNode&>(node)); return;
+            case NodeKind::FunctionDeclaration: self.Visit(static_cast<FunctionDeclarationNode&>(node)); return;
+            case NodeKind::Param: self.Visit(static_cast<ParamNode&>(node)); return;
+            case NodeKind::ParamList: self.Visit(static_cast<ParamListNode&>(node)); return;
+            case NodeKind::Assignment: self.Visit(static_cast<AssignmentNode&>(node)); return;
+            case NodeKind::BinaryOperation: self.Visit(static_cast<BinaryOperationNode&>(node)); return;
+            case NodeKind::Relational: self.Visit(static_cast<RelationalNode&>(node)); return;
+            case NodeKind::Equality: self.Visit(static_cast<EqualityNode&>(node)); return;
+            case NodeKind::LogicalOr: self.Visit(static_cast<LogicalOrNode&>(node)); return;
+            case NodeKind::LogicalAnd: self.Visit(static_cast<LogicalAndNode&>(node)); return;
+            case NodeKind::UnaryOperation: self.Visit(static_cast<UnaryOperationNode&>(node)); return;
+            case NodeKind::Literal: self.Visit(static_cast<LiteralNode&>(node)); return;
+            case NodeKind::Identifier: self.Visit(static_cast<IdentifierNode&>(node)); return;
+            case NodeKind::Type: self.Visit(static_cast<TypeNode&>(node)); return;
+            case NodeKind::IfStatement: self.Visit(static_cast<IfStatementNode&>(node)); return;
+            case NodeKind::ForStatement: self.Visit(static_cast<ForStatementNode&>(node)); return;
+            case NodeKind::ReturnStatement: self.Visit(static_cast<ReturnStatementNode&>(node)); return;
+            case NodeKind::PrintStatement: self.Visit(static_cast<PrintStatementNode&>(node)); return;
+            case NodeKind::ExpressionStatement: self.Visit(static_cast<ExpressionStatementNode&>(node)); return;
+            case NodeKind::CompoundStatement: self.Visit(static_cast<CompoundStatementNode&>(node)); return;
+            case NodeKind::ExprList: self.Visit(static_cast<ExprListNode&>(node)); return;
+            case NodeKind::FunctionCall: self.Visit(static_cast<FunctionCallNode&>(node)); return;
+            case NodeKind::Indexing: self.Visit(static_cast<IndexingNode&>(node)); return;
+        }
+    }
+};
+
+#endif
@@ -9,10 +9,10 @@ SemanticAnalyzer::SemanticAnalyzer()
     auto globalScope = std::make_unique<SymbolTable>("GLOBAL", 0);
     currentScope = globalScope.get();
 
-    currentScope->DefineSymbol(std::make_unique<BuiltInSymbol>("char"));
-    currentScope->DefineSymbol(std::make_unique<BuiltInSymbol>("integer"));
-    currentScope->DefineSymbol(std::make_unique<BuiltInSymbol>("boolean"));
-    currentScope->DefineSymbol(std::make_unique<BuiltInSymbol>("string"));
+    currentScope->DefineSymbol(std::make_unique<BuiltInSymbol>(keywordNameId(TokenType::KEYWORD_CHAR)));
+    currentScope->DefineSymbol(std::make_unique<BuiltInSymbol>(keywordNameId(TokenType::KEYWORD_INTEGER)));
+    currentScope->DefineSymbol(std::make_unique<BuiltInSymbol>(keywordNameId(TokenType::KEYWORD_BOOLEAN)));
+    currentScope->DefineSymbol(std::make_unique<BuiltInSymbol>(keywordNameId(TokenType::KEYWORD_STRING)));
 
     symbolTables.push_back(std::move(globalScope));
 }
@@ -32,7 +32,28 @@ void SemanticAnalyzer::ExitScope() {
 
 void SemanticAnalyzer::Analyze(ASTNode& root) {
     hasError = false;
-    root.Accept(*this);
+    Dispatch(root);
+}
+
+void SemanticAnalyzer::AnalyzeDeclaration(ASTNode& declaration) {
+    Dispatch(declaration);
+}
+
+// Nothing outside a function refers to its scopes, and node types are only
+// read while their declaration is being analyzed.
+void SemanticAnalyzer::ReleaseLocalScopes() {
+    currentScope = symbolTables.front().get();
+    symbolTables.resize(1);
+    nodeTypes.clear();
+}
+
+void SemanticAnalyzer::RenderLocalScopes() const {
+    Logger& logger = Logger::getInstance();
+    for (size_t i = 1; i < symbolTables.size(); i++) {
+        const SymbolTable& scope = *symbolTables[i];
+        logger.info("Symbol Table: " + scope.GetScopeName() + " (Level " + std::to_string(scope.GetScopeLevel()) + ")");
+        scope.Render();
+    }
 }
 
 const Symbol* SemanticAnalyzer::GetNodeType(const ASTNode* node) const {
@@ -46,7 +67,7 @@ void SemanticAnalyzer::SetNodeType(const ASTNode* node, const Symbol* type) {
 
 void SemanticAnalyzer::Visit(ProgramNode& node) {
     for (const auto& decl : node.declarations) {
-        decl->Accept(*this);
+        Dispatch(*decl);
     }
 }
 
@@ -54,27 +75,25 @@ void SemanticAnalyzer::Visit(DeclarationNode& node) {}
 
 void SemanticAnalyzer::Visit(VarDeclarationNode& node) {
     Logger& logger = Logger::getInstance();
-    const std::string& typeName = node.type.value;
-    const Symbol* typeSymbol = currentScope->LookUpSymbol(typeName);
+    const Symbol* typeSymbol = currentScope->LookUpSymbol(node.type.name);
 
     if (!typeSymbol) {
-        logger.error("Undefined type '" + typeName + "' at line " + std::to_string(node.type.line));
+        logger.error("Undefined type '" + std::string(node.type.value) + "' at line " + std::to_string(node.type.line()));
         hasError = true;
         return;
     }
 
-    const std::string& varName = node.identifier.value;
-    if (!currentScope->DefineSymbol(std::make_unique<VariableSymbol>(varName, std::to_string(currentScope->AllocateOffset()), typeSymbol))) {
-        logger.error("Redefinition of variable '" + varName + "' at line " + std::to_string(node.identifier.line));
+    if (!currentScope->DefineSymbol(std::make_unique<VariableSymbol>(node.identifier.name, std::to_string(currentScope->AllocateOffset()), typeSymbol))) {
+        logger.error("Redefinition of variable '" + std::string(node.identifier.value) + "' at line " + std::to_string(node.identifier.line()));
         hasError = true;
     }
 
     if (node.expression) {
-        node.expression->Accept(*this);
-        const Symbol* exprType = GetNodeType(node.expression.get());
-        if (exprType && exprType->GetName() != typeSymbol->GetName()) {
-            logger.error("Type mismatch in initialization of variable '" + varName +
-                         "' at line " + std::to_string(node.identifier.line) +
+        Dispatch(*node.expression);
+        const Symbol* exprType = GetNodeType(node.expression);
+        if (exprType && exprType->GetNameId() != typeSymbol->GetNameId()) {
+            logger.error("Type mismatch in initialization of variable '" + std::string(node.identifier.value) +
+                         "' at line " + std::to_string(node.identifier.line()) +
                          ". Expected: " + typeSymbol->GetName() +
                          ", Found: " + exprType->GetName() + ".");
             hasError = true;
@@ -86,26 +105,24 @@ void SemanticAnalyzer::Visit(VarDeclarationNode& node) {
 
 void SemanticAnalyzer::Visit(FunctionDeclarationNode& node) {
     Logger& logger = Logger::getInstance();
-    const std::string& returnTypeName = node.returnType.value;
-    const Symbol* returnTypeSymbol = currentScope->LookUpSymbol(returnTypeName);
+    const Symbol* returnTypeSymbol = currentScope->LookUpSymbol(node.returnType.name);
 
     if (!returnTypeSymbol) {
-        logger.error("Undefined return type '" + returnTypeName + "' for function '" + node.functionName.value +
-                     "' at line " + std::to_string(node.returnType.line));
+        logger.error("Undefined return type '" + std::string(node.returnType.value) + "' for function '" + std::string(node.functionName.value) +
+                     "' at line " + std::to_string(node.returnType.line()));
         hasError = true;
         return;
     }
 
     if (currentScope->GetScopeLevel() == 0) {
-        auto functionSymbol = std::make_unique<FunctionSymbol>(node.functionName.value, returnTypeSymbol);
+        auto functionSymbol = std::make_unique<FunctionSymbol>(node.functionName.name, returnTypeSymbol);
 
         for (const auto& param : node.parameters) {
-            const std::string& paramTypeName = param->type.value;
-            const Symbol* paramTypeSymbol = currentScope->LookUpSymbol(paramTypeName);
+            const Symbol* paramTypeSymbol = currentScope->LookUpSymbol(param->type.name);
 
             if (!paramTypeSymbol) {
-                logger.error("Undefined type '" + paramTypeName + "' for parameter '" + param->identifier.value +
-                             "' at line " + std::to_string(param->type.line));
+                logger.error("Undefined type '" + std::string(param->type.value) + "' for parameter '" + std::string(param->identifier.value) +
+                             "' at line " + std::to_string(param->type.line()));
                 hasError = true;
             } else {
                 functionSymbol->AddParameterType(paramTypeSymbol);
@@ -113,20 +130,24 @@ void SemanticAnalyzer::Visit(FunctionDeclarationNode& node) {
         }
         
         if (!currentScope->DefineSymbol(std::move(functionSymbol))) {
-            logger.error("Redefinition of function '" + node.functionName.value + "' at line " + std::to_string(node.functionName.line));
+            logger.error("Redefinition of function '" + std::string(node.functionName.value) + "' at line " + std::to_string(node.functionName.line()));
             hasError = true;
             return;
         }
     }
 
-    SymbolTable* functionScope = CreateNewScope(node.functionName.value);
+    SymbolTable* functionScope = CreateNewScope(std::string(node.functionName.value));
     functionScope->SetReturnType(returnTypeSymbol);
     for (const auto& param : node.parameters) {
-        param->Accept(*this);
+        Dispatch(*param);
     }
 
-    if (node.body) {
-        node.body->Accept(*this);
+    // A deferred body is parsed here; one with syntax errors comes back null.
+    bool deferred = static_cast<bool>(node.deferredBody);
+    if (ASTNode* body = node.Body()) {
+        Dispatch(*body);
+    } else if (deferred) {
+        hasError = true;
     }
 
     ExitScope();
@@ -134,18 +155,16 @@ void SemanticAnalyzer::Visit(FunctionDeclarationNode& node) {
 
 void SemanticAnalyzer::Visit(ParamNode& node) {
     Logger& logger = Logger::getInstance();
-    const std::string& paramName = node.identifier.value;
-    const std::string& paramTypeName = node.type.value;
-    const Symbol* paramTypeSymbol = currentScope->LookUpSymbol(paramTypeName);
+    const Symbol* paramTypeSymbol = currentScope->LookUpSymbol(node.type.name);
 
     if (!paramTypeSymbol) {
-        logger.error("Undefined type '" + paramTypeName + "' for parameter '" + paramName + "'");
+        logger.error("Undefined type '" + std::string(node.type.value) + "' for parameter '" + std::string(node.identifier.value) + "'");
         hasError = true;
         return;
     }
 
-    if (!currentScope->DefineSymbol(std::make_unique<VariableSymbol>(paramName, std::to_string(currentScope->AllocateOffset()), paramTypeSymbol))) {
-        logger.error("Redefinition of parameter '" + paramName + "'");
+    if (!currentScope->DefineSymbol(std::make_unique<VariableSymbol>(node.identifier.name, std::to_string(currentScope->AllocateOffset()), paramTypeSymbol))) {
+        logger.error("Redefinition of parameter '" + std::string(node.identifier.value) + "'");
         hasError = true;
     }
 
@@ -154,7 +173,7 @@ void SemanticAnalyzer::Visit(ParamNode& node) {
 
 void SemanticAnalyzer::Visit(ParamListNode& node) {
     for (const auto& param : node.parameters) {
-        param->Accept(*this);
+        Dispatch(*param);
     }
 }
 
@@ -163,14 +182,14 @@ void SemanticAnalyzer::Visit(ExpressionNode& node) {}
 void SemanticAnalyzer::Visit(AssignmentNode& node) {
     Logger& logger = Logger::getInstance();
 
-    node.left->Accept(*this);
-    node.right->Accept(*this);
+    Dispatch(*node.left);
+    Dispatch(*node.right);
 
-    const Symbol* leftType = GetNodeType(node.left.get());
-    const Symbol* rightType = GetNodeType(node.right.get());
+    const Symbol* leftType = GetNodeType(node.left);
+    const Symbol* rightType = GetNodeType(node.right);
 
     if (leftType && rightType && !leftType->IsCompatibleWith(rightType)) {
-        logger.error("Type mismatch in assignment at line " + std::to_string(node.op.line));
+        logger.error("Type mismatch in assignment at line " + std::to_string(node.op.line()));
         hasError = true;
     }
 
@@ -179,17 +198,17 @@ void SemanticAnalyzer::Visit(AssignmentNode& node) {
 
 void SemanticAnalyzer::Visit(BinaryOperationNode& node) {
     Logger& logger = Logger::getInstance();
-    node.left->Accept(*this);
-    node.right->Accept(*this);
+    Dispatch(*node.left);
+    Dispatch(*node.right);
 
-    const Symbol* leftType = GetNodeType(node.left.get());
-    const Symbol* rightType = GetNodeType(node.right.get());
+    const Symbol* leftType = GetNodeType(node.left);
+    const Symbol* rightType = GetNodeType(node.right);
     if (leftType && rightType) {
-        if (leftType->GetName() == rightType->GetName()) {
+        if (leftType->GetNameId() == rightType->GetNameId()) {
             SetNodeType(&node, leftType);
         } else {
-            logger.error("Type mismatch for operator '" + node.op.value +
-                         "' at line " + std::to_string(node.op.line) +
+            logger.error("Type mismatch for operator '" + std::string(node.op.value) +
+                         "' at line " + std::to_string(node.op.line()) +
                          ". Found: (" + leftType->GetName() + ", " + rightType->GetName() + ").");
             hasError = true;
         }
@@ -198,35 +217,35 @@ void SemanticAnalyzer::Visit(BinaryOperationNode& node) {
 
 void SemanticAnalyzer::Visit(UnaryOperationNode& node) {
     Logger& logger = Logger::getInstance();
-    node.expr->Accept(*this);
+    Dispatch(*node.expr);
     
-    const Symbol* exprType = GetNodeType(node.expr.get());
+    const Symbol* exprType = GetNodeType(node.expr);
     if (exprType) {
         SetNodeType(&node, exprType);
     } else {
-        logger.error("Undefined type in unary operation at line " + std::to_string(node.op.line));
+        logger.error("Undefined type in unary operation at line " + std::to_string(node.op.line()));
         hasError = true;
     }
 }
 
 void SemanticAnalyzer::Visit(LiteralNode& node) {
     if (node.literal.type == TokenType::LITERAL_INT) {
-        SetNodeType(&node, currentScope->LookUpSymbol("integer"));
+        SetNodeType(&node, currentScope->LookUpSymbol(keywordNameId(TokenType::KEYWORD_INTEGER)));
     } else if (node.literal.type == TokenType::LITERAL_STRING) {
-        SetNodeType(&node, currentScope->LookUpSymbol("string"));
+        SetNodeType(&node, currentScope->LookUpSymbol(keywordNameId(TokenType::KEYWORD_STRING)));
     } else if (node.literal.type == TokenType::LITERAL_CHAR) {
-        SetNodeType(&node, currentScope->LookUpSymbol("char"));
+        SetNodeType(&node, currentScope->LookUpSymbol(keywordNameId(TokenType::KEYWORD_CHAR)));
     } else if (node.literal.type == TokenType::KEYWORD_BOOLEAN) {
-        SetNodeType(&node, currentScope->LookUpSymbol("boolean"));
+        SetNodeType(&node, currentScope->LookUpSymbol(keywordNameId(TokenType::KEYWORD_BOOLEAN)));
     } 
 }
 
 
 void SemanticAnalyzer::Visit(IdentifierNode& node) {
     Logger& logger = Logger::getInstance();
-    const Symbol* symbol = currentScope->LookUpSymbol(node.identifier.value);
+    const Symbol* symbol = currentScope->LookUpSymbol(node.identifier.name);
     if (!symbol) {
-        logger.error("Undefined identifier '" + node.identifier.value + "' at line " + std::to_string(node.identifier.line));
+        logger.error("Undefined identifier '" + std::string(node.identifier.value) + "' at line " + std::to_string(node.identifier.line()));
         hasError = true;
     } else {
         SetNodeType(&node, symbol->type);
@@ -236,38 +255,38 @@ void SemanticAnalyzer::Visit(IdentifierNode& node) {
 void SemanticAnalyzer::Visit(TypeNode& node) {}
 
 void SemanticAnalyzer::Visit(RelationalNode& node) {
-    node.left->Accept(*this);
-    node.right->Accept(*this);
+    Dispatch(*node.left);
+    Dispatch(*node.right);
 }
 
 void SemanticAnalyzer::Visit(EqualityNode& node) {
-    node.left->Accept(*this);
-    node.right->Accept(*this);
+    Dispatch(*node.left);
+    Dispatch(*node.right);
 }
 
 void SemanticAnalyzer::Visit(LogicalOrNode& node) {
-    node.left->Accept(*this);
-    node.right->Accept(*this);
+    Dispatch(*node.left);
+    Dispatch(*node.right);
 }
 
 void SemanticAnalyzer::Visit(LogicalAndNode& node) {
-    node.left->Accept(*this);
-    node.right->Accept(*this);
+    Dispatch(*node.left);
+    Dispatch(*node.right);
 }
 
 void SemanticAnalyzer::Visit(StatementNode& node) {}
 
 void SemanticAnalyzer::Visit(IfStatementNode& node) {
-    node.condition->Accept(*this);
+    Dispatch(*node.condition);
     CreateNewScope("IF_BLOCK");
     if (node.ifBody) {
-        node.ifBody->Accept(*this);
+        Dispatch(*node.ifBody);
     }
     ExitScope();
 
     if (node.elseBody) {
         CreateNewScope("ELSE_BLOCK");
-        node.elseBody->Accept(*this);
+        Dispatch(*node.elseBody);
         ExitScope();
     }
 }
@@ -275,16 +294,16 @@ void SemanticAnalyzer::Visit(IfStatementNode& node) {
 void SemanticAnalyzer::Visit(ForStatementNode& node) {
     CreateNewScope("FOR_BLOCK");
     if (node.init) {
-        node.init->Accept(*this);
+        Dispatch(*node.init);
     }
     if (node.condition) {
-        node.condition->Accept(*this);
+        Dispatch(*node.condition);
     }
     if (node.increment) {
-        node.increment->Accept(*this);
+        Dispatch(*node.increment);
     }
     if (node.body) {
-        node.body->Accept(*this);
+        Dispatch(*node.body);
     }
     ExitScope();
 }
@@ -293,7 +312,7 @@ void SemanticAnalyzer::Visit(ReturnStatementNode& node) {
     Logger& logger = Logger::getInstance();
 
     if (node.expression) {
-        node.expression->Accept(*this);
+        Dispatch(*node.expression);
     }
 
     SymbolTable* functionScope = currentScope;
@@ -302,7 +321,7 @@ void SemanticAnalyzer::Visit(ReturnStatementNode& node) {
     }
 
     const Symbol* returnType = functionScope ? functionScope->GetReturnType() : nullptr;
-    const Symbol* exprType = node.expression ? GetNodeType(node.expression.get()) : nullptr;
+    const Symbol* exprType = node.expression ? GetNodeType(node.expression) : nullptr;
 
     if (returnType && exprType && !returnType->IsCompatibleWith(exprType)) {
         logger.error("Return type mismatch in function '" + (functionScope ? functionScope->GetScopeName() : "unknown") +
@@ -313,38 +332,38 @@ void SemanticAnalyzer::Visit(ReturnStatementNode& node) {
 }
 
 void SemanticAnalyzer::Visit(PrintStatementNode& node) {
-    node.exprList->Accept(*this);
+    Dispatch(*node.exprList);
 }
 
 void SemanticAnalyzer::Visit(ExpressionStatementNode& node) {
     if (node.expression) {
-        node.expression->Accept(*this);
+        Dispatch(*node.expression);
     }
 }
 
 void SemanticAnalyzer::Visit(CompoundStatementNode& node) {
     CreateNewScope("COMPOUND_STATEMENT");
     for (const auto& statement : node.statements) {
-        statement->Accept(*this);
+        Dispatch(*statement);
     }
     ExitScope();
 }
 
 void SemanticAnalyzer::Visit(ExprListNode& node) {
     for (const auto& expr : node.expressions) {
-        expr->Accept(*this);
+        Dispatch(*expr);
     }
 }
 
 void SemanticAnalyzer::Visit(FunctionCallNode& node) {
     Logger& logger = Logger::getInstance();
 
-    const Symbol* functionSymbol = currentScope->LookUpSymbol(node.functionName->identifier.value);
-    const FunctionSymbol* funcSymbol = dynamic_cast<const FunctionSymbol*>(functionSymbol);
+    const Symbol* functionSymbol = currentScope->LookUpSymbol(node.functionName->identifier.name);
+    const FunctionSymbol* funcSymbol = dyn_cast<FunctionSymbol>(functionSymbol);
 
     if (!functionSymbol) {
-        logger.error("Undefined identifier '" + node.functionName->identifier.value +
-                     "' at line " + std::to_string(node.functionName->identifier.line));
+        logger.error("Undefined identifier '" + std::string(node.functionName->identifier.value) +
+                     "' at line " + std::to_string(node.functionName->identifier.line()));
         hasError = true;
         return;
     }
@@ -354,15 +373,14 @@ void SemanticAnalyzer::Visit(FunctionCallNode& node) {
     std::vector<const Symbol*> argumentTypes;
     if (node.arguments) {
         for (const auto &arg : node.arguments->expressions) {
-            arg->Accept(*this);
-            argumentTypes.push_back(GetNodeType(arg.get()));
+            Dispatch(*arg);
+            argumentTypes.push_back(GetNodeType(arg));
         }
-        node.arguments->Accept(*this);
     }
 
     if (expectedParams.size() != argumentTypes.size()) {
-        logger.error("Incorrect number of arguments for function '" + node.functionName->identifier.value +
-                     "' at line " + std::to_string(node.functionName->identifier.line) +
+        logger.error("Incorrect number of arguments for function '" + std::string(node.functionName->identifier.value) +
+                     "' at line " + std::to_string(node.functionName->identifier.line()) +
                      ". Expected: " + std::to_string(expectedParams.size()) +
                      ", Found: " + std::to_string(argumentTypes.size()) + ".");
         hasError = true;
@@ -372,8 +390,8 @@ void SemanticAnalyzer::Visit(FunctionCallNode& node) {
         for (size_t i = 0; i < expectedParams.size(); ++i) {
         if (!expectedParams[i]->IsCompatibleWith(argumentTypes[i])) {
             logger.error("Type mismatch in argument " + std::to_string(i + 1) + " for function '" +
-                         node.functionName->identifier.value + "' at line " +
-                         std::to_string(node.functionName->identifier.line) +
+                         std::string(node.functionName->identifier.value) + "' at line " +
+                         std::to_string(node.functionName->identifier.line()) +
                          ". Expected: " + expectedParams[i]->GetName() +
                          ", Found: " + (argumentTypes[i] ? argumentTypes[i]->GetName() : "undefined") + ".");
             hasError = true;
@@ -384,8 +402,8 @@ void SemanticAnalyzer::Visit(FunctionCallNode& node) {
 }
 
 void SemanticAnalyzer::Visit(IndexingNode& node) {
-    node.base->Accept(*this);
-    node.index->Accept(*this);
+    Dispatch(*node.base);
+    Dispatch(*node.index);
 }
 
 void SemanticAnalyzer::Render() const {
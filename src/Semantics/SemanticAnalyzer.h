@@ -4,12 +4,14 @@
 #include "Symbol.h"
 #include "../AST/ASTVisitor.h"
 #include "../AST/AST.h"
+#include "../AST/StaticVisitor.h"
 #include <memory>
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
 
-class SemanticAnalyzer : public ASTNodeVisitor {
+class SemanticAnalyzer final : public ASTNodeVisitor, public StaticVisitor<SemanticAnalyzer> {
 private:
     std::vector<std::unique_ptr<SymbolTable>> symbolTables;
     SymbolTable* currentScope;
@@ -28,6 +30,14 @@ public:
     ~SemanticAnalyzer() override = default;
 
     void Analyze(ASTNode& root);
+    // Streaming use: analyzes one top-level declaration against the global
+    // scope. Unlike Analyze(), errors accumulate across calls.
+    void AnalyzeDeclaration(ASTNode& declaration);
+    // Frees every scope but the global one and the recorded node types. Call
+    // it once the declaration they came from has been emitted.
+    void ReleaseLocalScopes();
+    // Renders the scopes ReleaseLocalScopes() would free.
+    void RenderLocalScopes() const;
 
     void Visit(ProgramNode& node) override;
     void Visit(DeclarationNode& node) override;
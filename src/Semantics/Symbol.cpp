@@ -1,21 +1,22 @@
 #include "Symbol.h"
+#include <algorithm>
 #include <iostream>
 
 void BuiltInSymbol::Render() const {
-    std::cout << "Built-In Symbol: " << name << "\n";
+    std::cout << "Built-In Symbol: " << GetName() << "\n";
 }
 
 void VariableSymbol::Render() const {
-    std::cout << "Variable Symbol: " << name << ", Type: " << (type ? type->GetName() : "None") 
+    std::cout << "Variable Symbol: " << GetName() << ", Type: " << (type ? type->GetName() : "None") 
               << ", Offset: " << offset << "\n";
 }
 
 void NestedScopeSymbol::Render() const {
-    std::cout << "Nested Scope Symbol: " << name << "\n";
+    std::cout << "Nested Scope Symbol: " << GetName() << "\n";
 }
 
 void FunctionSymbol::Render() const {
-    std::cout << "Function Symbol: " << name << ", Return Type: " << type->GetName() << std::endl;
+    std::cout << "Function Symbol: " << GetName() << ", Return Type: " << type->GetName() << std::endl;
 }
 
 void FunctionSymbol::AddParameterType(const Symbol* type) {
@@ -27,20 +28,24 @@ const std::vector<const Symbol*>& FunctionSymbol::GetParameterTypes() const {
 }
 
 SymbolTable::SymbolTable(const std::string& name, int level, SymbolTable* parent)
-    : scopeName(name), scopeLevel(level), parentScope(parent) {}
+    : scopeName(name), scopeLevel(level), parentScope(parent), returnType(nullptr) {}
 
 bool SymbolTable::DefineSymbol(std::unique_ptr<Symbol> symbol) {
-    const std::string& name = symbol->GetName();
+    NameId name = symbol->GetNameId();
     auto result = symbols.insert({name, std::move(symbol)});
     return result.second;
 }
 
-const Symbol* SymbolTable::LookUpSymbol(const std::string& name) const {
-    auto it = symbols.find(name);
-    if (it != symbols.end()) {
-        return it->second.get();
+const Symbol* SymbolTable::LookUpSymbol(NameId name) const {
+    // Walks out through the enclosing scopes; deeply nested blocks make this
+    // chain as long as the nesting, so it is a loop rather than a recursion.
+    for (const SymbolTable* scope = this; scope; scope = scope->parentScope) {
+        auto it = scope->symbols.find(name);
+        if (it != scope->symbols.end()) {
+            return it->second.get();
+        }
     }
-    return parentScope ? parentScope->LookUpSymbol(name) : nullptr;
+    return nullptr;
 }
 
 int SymbolTable::AllocateOffset() {
@@ -51,7 +56,16 @@ int SymbolTable::AllocateOffset() {
 
 void SymbolTable::Render() const {
     std::cout << "Symbol Table: " << scopeName << " (Level " << scopeLevel << ")\n";
+
+    // Symbols are keyed by id; list them alphabetically for stable output.
+    const StringInterner& names = StringInterner::getInstance();
+    std::vector<std::pair<std::string_view, const Symbol*>> sorted;
+    sorted.reserve(symbols.size());
     for (const auto& entry : symbols) {
+        sorted.emplace_back(names.lookup(entry.first), entry.second.get());
+    }
+    std::sort(sorted.begin(), sorted.end());
+    for (const auto& entry : sorted) {
         entry.second->Render();
     }
     std::cout << "\n";
@@ -1,35 +1,51 @@
 #ifndef SYMBOL_H
 #define SYMBOL_H
 
+#include <cstdint>
 #include <string>
-#include <map>
+#include <unordered_map>
 #include <memory>
 #include <vector>
 
+#include "../utils/casting.h"
+#include "../utils/interner.h"
+
+// One tag per concrete symbol class, for isa/dyn_cast (utils/casting.h).
+enum class SymbolKind : uint8_t {
+    BuiltIn,
+    Variable,
+    NestedScope,
+    Function,
+};
+
 class Symbol {
 protected:
-    std::string name;
+    NameId name;
     std::string offset;
     friend class SymbolTable;
 public:
     const Symbol* type;
-    Symbol(const std::string& n, const std::string& off = "0", const Symbol* t = nullptr) 
-        : name(n), offset(off), type(t) {}
+    const SymbolKind kind;
+    Symbol(SymbolKind k, NameId n, const std::string& off = "0", const Symbol* t = nullptr) 
+        : name(n), offset(off), type(t), kind(k) {}
     virtual ~Symbol() = default;
 
-    std::string GetName() const { return name; }
+    NameId GetNameId() const { return name; }
+    std::string GetName() const { return std::string(StringInterner::getInstance().lookup(name)); }
     virtual void Render() const = 0;
     virtual bool IsCompatibleWith(const Symbol* other) const = 0;
 };
 
 class BuiltInSymbol : public Symbol {
 public:
-    BuiltInSymbol(const std::string& n) : Symbol(n) {}
+    BuiltInSymbol(NameId n) : Symbol(SymbolKind::BuiltIn, n) {}
     ~BuiltInSymbol() override = default;
 
+    static bool classof(const Symbol* symbol) { return symbol->kind == SymbolKind::BuiltIn; }
+
     void Render() const override;
     bool IsCompatibleWith(const Symbol* other) const override {
-        const auto* otherBuiltIn = dynamic_cast<const BuiltInSymbol*>(other);
+        const auto* otherBuiltIn = dyn_cast<BuiltInSymbol>(other);
         return otherBuiltIn && this->name == otherBuiltIn->name;
     }
 
@@ -37,10 +53,12 @@ public:
 
 class VariableSymbol : public Symbol {
 public:
-    VariableSymbol(const std::string& n, const std::string& off, const Symbol* t) 
-        : Symbol(n, off, t) {}
+    VariableSymbol(NameId n, const std::string& off, const Symbol* t) 
+        : Symbol(SymbolKind::Variable, n, off, t) {}
     ~VariableSymbol() override = default;
 
+    static bool classof(const Symbol* symbol) { return symbol->kind == SymbolKind::Variable; }
+
     bool IsCompatibleWith(const Symbol* other) const override {
         return this->type->IsCompatibleWith(other);
     }
@@ -50,9 +68,11 @@ public:
 
 class NestedScopeSymbol : public Symbol {
 public:
-    NestedScopeSymbol(const std::string& n) : Symbol(n) {}
+    NestedScopeSymbol(NameId n) : Symbol(SymbolKind::NestedScope, n) {}
     ~NestedScopeSymbol() override = default;
 
+    static bool classof(const Symbol* symbol) { return symbol->kind == SymbolKind::NestedScope; }
+
     void Render() const override;
 };
 
@@ -60,10 +80,12 @@ class FunctionSymbol : public Symbol {
 public:
     std::vector<const Symbol*> parameterTypes;
 
-    FunctionSymbol(const std::string& n, const Symbol* retType)
-        : Symbol(n, "0", retType) {}
+    FunctionSymbol(NameId n, const Symbol* retType)
+        : Symbol(SymbolKind::Function, n, "0", retType) {}
     ~FunctionSymbol() override = default;
 
+    static bool classof(const Symbol* symbol) { return symbol->kind == SymbolKind::Function; }
+
     void AddParameterType(const Symbol* type);
 
     const std::vector<const Symbol*>& GetParameterTypes() const;
@@ -77,7 +99,7 @@ public:
 
 class SymbolTable {
 private:
-    std::map<std::string, std::unique_ptr<Symbol>> symbols;
+    std::unordered_map<NameId, std::unique_ptr<Symbol>> symbols;
     std::string scopeName;
     int scopeLevel;
     SymbolTable* parentScope;
@@ -88,7 +110,7 @@ public:
     SymbolTable(const std::string& name, int level, SymbolTable* parent = nullptr);
 
     bool DefineSymbol(std::unique_ptr<Symbol> symbol);
-    const Symbol* LookUpSymbol(const std::string& name) const;
+    const Symbol* LookUpSymbol(NameId name) const;
     int GetScopeLevel() const { return scopeLevel; }
     std::string GetScopeName() const { return scopeName; }
     SymbolTable* GetParentScope() const { return parentScope; }
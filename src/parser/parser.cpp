@@ -1,53 +1,369 @@
 #include "parser.h"
 #include "../utils/logger.h"
+#include "../utils/stack.h"
+#include "../utils/threadpool.h"
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+#include <iterator>
 #include <memory>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Conjuntos FIRST y FOLLOW de la gramática, calculados en compilación.
+constexpr TokenSet TYPES = {TokenType::KEYWORD_INTEGER, TokenType::KEYWORD_BOOLEAN, TokenType::KEYWORD_CHAR,
+                            TokenType::KEYWORD_STRING, TokenType::KEYWORD_VOID};
+constexpr TokenSet LITERALS = {TokenType::LITERAL_INT, TokenType::LITERAL_CHAR, TokenType::KEYWORD_FALSE,
+                               TokenType::KEYWORD_TRUE, TokenType::LITERAL_STRING};
+
+constexpr TokenSet FIRST_EXPRESSION = LITERALS | TokenSet{TokenType::OPERATOR_NOT, TokenType::OPERATOR_MINUS,
+                                                          TokenType::IDENTIFIER, TokenType::LEFT_PARENTHESIS};
+constexpr TokenSet FIRST_STATEMENT = TYPES | FIRST_EXPRESSION |
+                                     TokenSet{TokenType::LEFT_BRACE, TokenType::KEYWORD_FOR, TokenType::KEYWORD_IF,
+                                              TokenType::KEYWORD_RETURN, TokenType::KEYWORD_PRINT, TokenType::SEMICOLON};
+
+constexpr TokenSet FOLLOW_EXPRESSION = {TokenType::RIGHT_PARENTHESIS, TokenType::RIGHT_BRACKET,
+                                        TokenType::COMMA, TokenType::SEMICOLON};
+// Cada nivel binario puede ir seguido de lo que sigue a su nivel padre y de los operadores de este.
+constexpr TokenSet FOLLOW_OR = FOLLOW_EXPRESSION | TokenSet{TokenType::OPERATOR_ASSIGN};
+constexpr TokenSet FOLLOW_AND = FOLLOW_OR | FIRST_EXPRESSION | TokenSet{TokenType::OPERATOR_OR};
+constexpr TokenSet FOLLOW_EQUALITY = FOLLOW_OR | TokenSet{TokenType::OPERATOR_OR, TokenType::OPERATOR_AND};
+constexpr TokenSet FOLLOW_RELATIONAL = FOLLOW_EQUALITY | TokenSet{TokenType::OPERATOR_EQUAL, TokenType::OPERATOR_NOT_EQUAL};
+constexpr TokenSet FOLLOW_ADDITIVE = FOLLOW_RELATIONAL | TokenSet{TokenType::OPERATOR_LESS_THAN, TokenType::OPERATOR_GREATER_THAN,
+                                                                  TokenType::OPERATOR_LESS_EQUAL, TokenType::OPERATOR_GREATER_EQUAL};
+constexpr TokenSet FOLLOW_MULTIPLICATIVE = FOLLOW_ADDITIVE | TokenSet{TokenType::OPERATOR_PLUS, TokenType::OPERATOR_MINUS};
+constexpr TokenSet FOLLOW_FACTOR = FOLLOW_MULTIPLICATIVE | TokenSet{TokenType::OPERATOR_MULTIPLY, TokenType::OPERATOR_DIVIDE,
+                                                                    TokenType::OPERATOR_MOD};
+// Un identificador sin '(' todavía puede ir seguido de un índice.
+constexpr TokenSet FOLLOW_CALLEE = FOLLOW_FACTOR | TokenSet{TokenType::LEFT_BRACKET};
+constexpr TokenSet FOLLOW_IF = FIRST_STATEMENT | TokenSet{TokenType::RIGHT_BRACE};
+
+// Tokens antes de los que se detiene la recuperación de errores en la lista de
+// declaraciones y en la de sentencias de un bloque.
+constexpr TokenSet DECLARATION_ANCHORS = TYPES;
+constexpr TokenSet STATEMENT_ANCHORS = TYPES | TokenSet{TokenType::KEYWORD_IF, TokenType::KEYWORD_FOR, TokenType::KEYWORD_RETURN,
+                                                         TokenType::KEYWORD_PRINT, TokenType::RIGHT_BRACE};
 
-Parser::Parser(const std::vector<Token>& tokens) : tokens(tokens), current(0) {}
+}
+
+Parser::Parser(ASTContext& context, const TokenBuffer& tokens)
+    : context(context), bodyContext(&context), tokens(tokens), buffer(&tokens) {}
+
+Parser::Parser(ASTContext& context, Scanner& scanner) : context(context), bodyContext(&context), tokens(scanner) {}
+
+Parser::Parser(ASTContext& context, const TokenBuffer& tokens, size_t begin, size_t end)
+    : context(context), bodyContext(&context), tokens(tokens, begin, end), buffer(&tokens) {}
 
 bool Parser::parse() {
-    Logger& logger = Logger::getInstance();
-    logger.info("Iniciando el análisis del programa.");
+    LOG_INFO("Iniciando el análisis del programa.");
     root = program();
+    return finish();
+}
+
+namespace {
+
+// Índice del token siguiente a cada declaración de nivel superior: un ';' o
+// una '}' que deja la profundidad de llaves en 0, fuera de paréntesis. Como
+// skipToClosingParenthesis(), una llave cierra cualquier paréntesis abierto.
+// Las declaraciones mal cerradas se quedan en el tramo de la siguiente.
+std::vector<size_t> declarationEnds(const TokenBuffer& tokens) {
+    std::vector<size_t> ends;
+    size_t depth = 0;
+    size_t parentheses = 0;
+    for (size_t i = 0; i < tokens.size(); i++) {
+        switch (tokens.kind(i)) {
+            case TokenType::LEFT_PARENTHESIS:
+                parentheses++;
+                break;
+            case TokenType::RIGHT_PARENTHESIS:
+                if (parentheses > 0) parentheses--;
+                break;
+            case TokenType::LEFT_BRACE:
+                parentheses = 0;
+                depth++;
+                break;
+            case TokenType::RIGHT_BRACE:
+                parentheses = 0;
+                if (depth > 0) depth--;
+                if (depth == 0) ends.push_back(i + 1);
+                break;
+            case TokenType::SEMICOLON:
+                if (depth == 0 && parentheses == 0) ends.push_back(i + 1);
+                break;
+            default:
+                break;
+        }
+    }
+    return ends;
+}
+
+// Resultado de analizar un tramo en un hilo del pool.
+struct ParsedRange {
+    std::unique_ptr<ASTContext> context;
+    ProgramNode* program;
+    std::vector<SyntaxError> errors;
+    // La última declaración del tramo: dónde empieza y cuántas declaraciones
+    // y errores había antes de ella.
+    size_t lastBegin;
+    size_t declarationsBeforeLast;
+    size_t errorsBeforeLast;
+};
+
+}
+
+/*
+Las declaraciones de nivel superior no dependen unas de otras: se agrupan en
+tramos contiguos de tamaño parecido, cada tramo lo analiza un Parser propio en
+un hilo del pool con su propio ASTContext, y las declaraciones y los errores se
+juntan en el orden del fuente.
+
+Un tramo que termina en una declaración con errores puede haberse recuperado
+contra su final artificial, donde parse() habría seguido saltando tokens. Esa
+declaración se descarta y se analiza de nuevo aquí, de forma secuencial, hasta
+caer justo en el comienzo de otro tramo. Así el resultado, errores incluidos,
+es el mismo que el de parse() para cualquier número de hilos.
+*/
+bool Parser::parseParallel(unsigned threadCount) {
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    if (!buffer || threadCount < 2 || buffer->size() < MIN_PARALLEL_TOKENS) {
+        return parse();
+    }
+
+    // Varios tramos por hilo para que un tramo lento no deje a los demás esperando.
+    size_t endOfFile = buffer->size() - 1;
+    size_t target = endOfFile / (threadCount * 4) + 1;
+    std::vector<std::pair<size_t, size_t>> ranges;
+    size_t begin = 0;
+    for (size_t end : declarationEnds(*buffer)) {
+        if (end - begin >= target) {
+            ranges.emplace_back(begin, end);
+            begin = end;
+        }
+    }
+    if (begin < endOfFile || ranges.empty()) ranges.emplace_back(begin, endOfFile);
+    if (ranges.size() < 2) {
+        return parse();
+    }
+
+    LOG_INFO("Iniciando el análisis del programa en " + std::to_string(ranges.size()) + " tramos.");
+    ThreadPool pool(threadCount);
+    std::vector<std::future<ParsedRange>> results;
+    results.reserve(ranges.size());
+    for (const auto& range : ranges) {
+        results.push_back(pool.submit([this, range] {
+            auto partContext = std::make_unique<ASTContext>();
+            Parser part(*partContext, *buffer, range.first, range.second);
+            part.bodyContext = bodyContext;
+            part.skeleton = skeleton;
+            ProgramNode* program = partContext->Create<ProgramNode>();
+            ParsedRange parsed{nullptr, program, {}, range.first, 0, 0};
+            while (!part.isAtEnd()) {
+                parsed.lastBegin = part.tokens.position();
+                parsed.declarationsBeforeLast = program->declarations.size();
+                parsed.errorsBeforeLast = part.errors.size();
+                part.topLevelDeclaration(*program);
+            }
+            parsed.context = std::move(partContext);
+            parsed.errors = std::move(part.errors);
+            return parsed;
+        }));
+    }
+
+    auto programNode = context.Create<ProgramNode>();
+    size_t reached = 0; // token hasta el que coincide con parse()
+    for (size_t k = 0; k < results.size(); k++) {
+        ParsedRange part = results[k].get();
+        if (ranges[k].first != reached) continue; // el análisis secuencial ya pasó por aquí
+        context.Adopt(*part.context);
+
+        ProgramNode& program = *part.program;
+        size_t declarationCount = program.declarations.size();
+        size_t errorCount = part.errors.size();
+        bool cleanEnd = k + 1 == ranges.size() || part.errorsBeforeLast == errorCount;
+        if (!cleanEnd) {
+            declarationCount = part.declarationsBeforeLast;
+            errorCount = part.errorsBeforeLast;
+        }
+        for (size_t i = 0; i < declarationCount; i++) {
+            programNode->AddDeclaration(program.declarations[i], program.extents[i]);
+        }
+        errors.insert(errors.end(), part.errors.begin(), part.errors.begin() + errorCount);
+        if (cleanEnd) {
+            reached = ranges[k].second;
+            continue;
+        }
+
+        tokens = TokenStream(*buffer, part.lastBegin, buffer->size());
+        size_t nextRange = k + 1;
+        while (!isAtEnd()) {
+            topLevelDeclaration(*programNode);
+            size_t position = tokens.position();
+            while (nextRange < ranges.size() && ranges[nextRange].first < position) nextRange++;
+            if (nextRange < ranges.size() && ranges[nextRange].first == position) break;
+        }
+        reached = tokens.position();
+    }
+    failed = failed || !errors.empty();
+    root = programNode;
+    // Como después de parse(), el flujo queda al final del archivo.
+    tokens = TokenStream(*buffer, endOfFile, buffer->size());
+    return finish();
+}
+
+void Parser::reportErrors() {
+    for (const SyntaxError& syntaxError : errors) {
+        LOG_ERROR("Line " + std::to_string(syntaxError.line) + " " + syntaxError.message);
+    }
+}
+
+namespace {
+
+// Primer token del buffer que empieza en `offset` o después.
+size_t firstTokenFrom(const TokenBuffer& tokens, uint32_t offset) {
+    size_t low = 0;
+    size_t high = tokens.size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (tokens.offset(middle) < offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+int64_t sizeChange(const SourceEdit& edit) {
+    return static_cast<int64_t>(edit.inserted.size()) - static_cast<int64_t>(edit.removed);
+}
+
+}
 
+/*
+Igual que Scanner::relex, pero con declaraciones en lugar de tokens. Las
+declaraciones que terminan antes de una edición se mueven al AST nuevo con su
+rango desplazado. Desde el final de la última reutilizada se analiza el buffer
+nuevo declaración a declaración hasta que el siguiente token vuelve a estar
+donde empezaba una declaración antigua, pasadas ya las ediciones; desde ahí se
+vuelven a reutilizar. Las declaraciones de nivel superior no dependen unas de
+otras, así que el resultado es el mismo que el de parse().
+*/
+bool Parser::reparse(ProgramNode* previous, const std::vector<SourceEdit>& edits) {
+    if (!buffer || !previous || previous->extents.size() != previous->declarations.size()) {
+        return parse();
+    }
+    LOG_INFO("Reanalizando el programa tras " + std::to_string(edits.size()) + " ediciones.");
+
+    std::vector<ASTNode*>& oldDeclarations = previous->declarations;
+    const std::vector<SourceRange>& oldExtents = previous->extents;
+    const size_t oldCount = oldDeclarations.size();
+    auto programNode = context.Create<ProgramNode>();
+
+    size_t oldIndex = 0; // primera declaración antigua aún no reutilizada ni descartada
+    int64_t delta = 0;   // offset nuevo - offset antiguo tras las ediciones ya vistas
+    size_t next = 0;     // siguiente edición
+    uint32_t resume = 0; // offset nuevo hasta el que ya está todo analizado
+
+    auto reuseUntil = [&](size_t end) {
+        for (; oldIndex < end; oldIndex++) {
+            SourceRange extent = oldExtents[oldIndex];
+            extent.begin = static_cast<uint32_t>(extent.begin + delta);
+            extent.end = static_cast<uint32_t>(extent.end + delta);
+            programNode->AddDeclaration(oldDeclarations[oldIndex], extent);
+            resume = extent.end;
+        }
+    };
+
+    while (next < edits.size()) {
+        const SourceEdit& edit = edits[next];
+        size_t damaged = oldIndex;
+        while (damaged < oldCount && oldExtents[damaged].end <= edit.offset) damaged++;
+        reuseUntil(damaged);
+
+        // Se reanaliza desde el final de lo ya analizado: la edición puede
+        // haber convertido en tokens un comentario anterior a ella.
+        tokens = TokenStream(*buffer, firstTokenFrom(*buffer, resume), buffer->size());
+
+        delta += sizeChange(edit);
+        int64_t editEnd = static_cast<int64_t>(edit.offset + edit.removed);
+        next++;
+
+        while (true) {
+            if (isAtEnd()) {
+                // El resto del archivo ya se analizó de nuevo.
+                oldIndex = oldCount;
+                next = edits.size();
+                break;
+            }
+            topLevelDeclaration(*programNode);
+
+            int64_t oldOffset = static_cast<int64_t>(peek().offset) - delta;
+            // Si el análisis alcanza la siguiente edición, esta se une al tramo.
+            while (next < edits.size() && oldOffset >= static_cast<int64_t>(edits[next].offset)) {
+                delta += sizeChange(edits[next]);
+                editEnd = static_cast<int64_t>(edits[next].offset + edits[next].removed);
+                oldOffset = static_cast<int64_t>(peek().offset) - delta;
+                next++;
+            }
+            if (isAtEnd() || oldOffset < editEnd) continue;
+            while (oldIndex < oldCount && oldExtents[oldIndex].begin < oldOffset) oldIndex++;
+            if (oldIndex < oldCount && oldExtents[oldIndex].begin == oldOffset) {
+                resume = peek().offset;
+                break;
+            }
+        }
+    }
+    reuseUntil(oldCount);
+
+    root = programNode;
+    tokens = TokenStream(*buffer, buffer->size() - 1, buffer->size());
+    return finish();
+}
+
+// Informa de los errores en orden y deja el AST solo si no hubo ninguno.
+bool Parser::finish() {
+    reportErrors();
     if (!failed) {
-        logger.info("El input pertenece a la gramática. AST construido");
+        LOG_INFO("El input pertenece a la gramática. AST construido");
     } else {
-        logger.info("El input no pertenece a la gramática.");
+        LOG_INFO("El input no pertenece a la gramática: " + std::to_string(errors.size()) + " errores.");
         root = nullptr;
     }
     return failed;
 }
 
-UnqPtr<ProgramNode> Parser::getAST() {
+ProgramNode* Parser::getAST() {
     if (failed) {
-        Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "El análisis falló. No se construyó el AST.");
+        LOG_ERROR("Line " + std::to_string(peek().line() ) + " " + "El análisis falló. No se construyó el AST.");
         return nullptr;
     }
-    return std::unique_ptr<ProgramNode>(static_cast<ProgramNode*>(root.release()));
+    return root;
 }
 
 bool Parser::isAtEnd() {
-    return current >= tokens.size() || tokens[current].type == TokenType::END_OF_FILE;
+    return tokens.peekKind() == TokenType::END_OF_FILE;
 }
 
-Token Parser::peek() {
-    return tokens[current];
+const Token& Parser::peek() {
+    return tokens.peek();
 }
 
-Token Parser::advance() {
-    if (!isAtEnd()) current++;
-    Logger::getInstance().debug("Token avanzado: " + previous().value);
+const Token& Parser::advance() {
+    if (!isAtEnd()) tokens.advance();
+    LOG_DEBUG("Token avanzado: " + std::string(previous().value));
     return previous();
 }
 
-Token Parser::previous() {
-    return tokens[current - 1];
+const Token& Parser::previous() {
+    return tokens.previous();
 }
 
 bool Parser::match(TokenType type) {
     if (check(type)) {
         advance();
-        Logger::getInstance().debug("Coincidencia encontrada: " + previous().value);
+        LOG_DEBUG("Coincidencia encontrada: " + std::string(previous().value));
         return true;
     }
     return false;
@@ -55,104 +371,152 @@ bool Parser::match(TokenType type) {
 
 bool Parser::check(TokenType type) {
     if (isAtEnd()) return false;
-    return peek().type == type;
+    return tokens.peekKind() == type;
+}
+
+// Ningún conjunto contiene END_OF_FILE, así que no hace falta mirar isAtEnd().
+bool Parser::checkAny(TokenSet types) {
+    return types.contains(tokens.peekKind());
+}
+
+bool Parser::matchAny(TokenSet types) {
+    if (checkAny(types)) {
+        advance();
+        LOG_DEBUG("Coincidencia encontrada: " + std::string(previous().value));
+        return true;
+    }
+    return false;
 }
 
-UnqPtr<ASTNode> Parser::consume(TokenType type, const std::string& message) {
-    Logger::getInstance().debug("Trying to consume " + tokens[current].value);
+bool Parser::consume(TokenType type, const std::string& message) {
+    LOG_DEBUG("Trying to consume " + std::string(peek().value));
     if (!match(type)) {
-        Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + message);
-        synchronize();
-        return nullptr;
+        error(message);
+        return false;
     }
-    Logger::getInstance().debug("CONSUMED and current token is " + tokens[current].value);
-    return nullptr;
-    //throw std::runtime_error(message);
+    LOG_DEBUG("CONSUMED and current token is " + std::string(peek().value));
+    return true;
+}
+
+// Registra un error de sintaxis y entra en modo pánico. Mientras dura, los
+// errores siguientes se descartan: casi siempre son consecuencia del primero.
+// finish() los informa todos al terminar, en el orden del fuente.
+void Parser::error(const std::string& message) {
+    failed = true;
+    if (panicMode) return;
+    panicMode = true;
+    errors.push_back(SyntaxError{peek().line(), message});
 }
 
-void Parser::synchronize() {
-    Logger::getInstance().debug("SYNC from " + tokens[current].value);
-    advance();
+// Descarta tokens hasta un punto seguro: justo después de un ';' o de un
+// bloque '{...}' completo, o antes de un token de `anchors`. Cada token se
+// descarta una sola vez, así que recuperarse es lineal en el tamaño del archivo.
+void Parser::synchronize(TokenSet anchors) {
+    LOG_DEBUG("SYNC from " + std::string(peek().value));
+    size_t depth = 0;
     while (!isAtEnd()) {
-        if (previous().type == TokenType::SEMICOLON){
-            if(tokens[current].type == TokenType::LEFT_BRACKET) advance();
-            Logger::getInstance().debug("SYNC ended at " + tokens[current].value);
-            program();
-            return;
-            }; // Retorna al encontrar un punto y coma
-        Logger::getInstance().debug("SYNC advance " + tokens[current].value);
+        TokenType kind = tokens.peekKind();
+        if (depth == 0 && anchors.contains(kind)) break;
         advance();
+        if (kind == TokenType::LEFT_BRACE) {
+            depth++;
+        } else if (kind == TokenType::RIGHT_BRACE) {
+            if (depth <= 1) break; // bloque completo, o '}' suelto fuera de un bloque
+            depth--;
+        } else if (kind == TokenType::SEMICOLON && depth == 0) {
+            break;
+        }
     }
-    
-    program();
+    panicMode = false;
+    LOG_DEBUG("SYNC ended at " + std::string(peek().value));
 }
 
-/* Program -> Declaration ProgramPrime */
-UnqPtr<ProgramNode> Parser::program() {
-    Logger::getInstance().debug("Analizando 'program' con: " + tokens[current].value);
-
-    auto programNode = std::make_unique<ProgramNode>();
-    while (!isAtEnd()) { // bucle elimina ProgramPrime(?
-        UnqPtr<ASTNode> decl = declaration();
-        if (!decl) {
-            failed = true;
-            return nullptr;
+// Recuperación dentro de una cabecera entre paréntesis (parámetros, 'if',
+// 'for'): salta hasta su ')' para poder analizar el cuerpo de todas formas.
+// Devuelve false si antes aparece una llave o se acaba el archivo.
+bool Parser::skipToClosingParenthesis() {
+    size_t depth = 0;
+    while (!isAtEnd() && !check(TokenType::LEFT_BRACE) && !check(TokenType::RIGHT_BRACE)) {
+        TokenType kind = tokens.peekKind();
+        if (kind == TokenType::RIGHT_PARENTHESIS) {
+            if (depth == 0) break;
+            depth--;
+        } else if (kind == TokenType::LEFT_PARENTHESIS) {
+            depth++;
         }
-        programNode->AddDeclaration(std::move(decl));
+        advance();
     }
-    return programNode;
-    /* failed = !(declaration() && programPrime());
-    return failed; */
+    if (!match(TokenType::RIGHT_PARENTHESIS)) return false;
+    panicMode = false;
+    return true;
 }
 
-// ProgramPrime -> Declaration ProgramPrime
-// ProgramPrime -> epsilon
-bool Parser::programPrime() {
-    Logger::getInstance().debug("Analizando 'programPrime' con: " + tokens[current].value);
-    
-    if (isAtEnd()) {
-        Logger::getInstance().debug("'programPrime' encontrado epsilon");
-        return true;
-    }
+/* Program -> Declaration ProgramPrime
+   ProgramPrime -> Declaration ProgramPrime | epsilon
+   Una declaración con errores se salta hasta la siguiente y se sigue. */
+ProgramNode* Parser::program() {
+    LOG_DEBUG("Analizando 'program' con: " + std::string(peek().value));
 
-    if (!checkForDeclarationStart()) {
-        Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "No se encontró un tipo de dato válido en 'programPrime' para " + tokens[current].value);
-        synchronize();
-        return false;
+    auto programNode = context.Create<ProgramNode>();
+    while (!isAtEnd()) {
+        topLevelDeclaration(*programNode);
     }
+    return programNode;
+}
 
-    if (!declaration()) {
-        Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'declaration' dentro de 'programPrime' para " + tokens[current].value);
-        synchronize();
-        return false;
-    }
+void Parser::topLevelDeclaration(ProgramNode& programNode) {
+    SourceRange extent;
+    ASTNode* decl = topLevelDeclaration(extent);
+    if (decl) programNode.AddDeclaration(decl, extent);
+}
+
+// Una declaración de nivel superior y su rango en el fuente. Si tiene
+// errores se salta hasta la siguiente y devuelve nullptr.
+ASTNode* Parser::topLevelDeclaration(SourceRange& extent) {
+    uint32_t begin = peek().offset;
+    ASTNode* decl = declaration();
+    if (decl) {
+        const Token& last = previous();
+        extent = SourceRange{begin, last.offset + last.length};
+        panicMode = false;
+        return decl;
+    }
+    synchronize(DECLARATION_ANCHORS);
+    return nullptr;
+}
 
-    return programPrime();
+// Los errores se informan en cuanto aparecen: en este modo no hay un final
+// del análisis en el que juntarlos.
+bool Parser::parseDeclaration(ASTNode*& declaration) {
+    declaration = nullptr;
+    if (isAtEnd()) return false;
+    size_t reported = errors.size();
+    SourceRange extent;
+    declaration = topLevelDeclaration(extent);
+    for (size_t i = reported; i < errors.size(); i++) {
+        LOG_ERROR("Line " + std::to_string(errors[i].line) + " " + errors[i].message);
+    }
+    return true;
 }
 
 /*
 Declaration -> Type Identifier DeclarationPrime 
 */
-UnqPtr<ASTNode> Parser::declaration() {
-    Logger::getInstance().debug("Analizando 'declaration' con: " + tokens[current].value);
+ASTNode* Parser::declaration() {
+    LOG_DEBUG("Analizando 'declaration' con: " + std::string(peek().value));
         
     Token typeToken = peek();
     if (type()) {
         if (match(TokenType::IDENTIFIER)) {
             Token identifierToken = previous();
-            Logger::getInstance().debug("Encontrado identificador en 'declaration': " + previous().value);
+            LOG_DEBUG("Encontrado identificador en 'declaration': " + std::string(previous().value));
             return declarationPrime(typeToken, identifierToken);
-        } else {
-            Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Se esperaba un identificador después del tipo en 'declaration'.");
-            synchronize();
-            return nullptr;
-            //throw std::runtime_error("Se esperaba un identificador después del tipo.");
         }
+        error("Se esperaba un identificador después del tipo en 'declaration'.");
+        return nullptr;
     }
 
-    //Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'declaration', no se encontró un tipo válido para " + tokens[current].value + " quizás olvidaste un ';'");
-    Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en la declaración, no se esperaba " + tokens[current].value + " quizás olvidaste un ';'");
-    synchronize();
+    error("Error en la declaración, no se esperaba " + std::string(peek().value) + " quizás olvidaste un ';'");
     return nullptr;
 }
 
@@ -160,51 +524,70 @@ UnqPtr<ASTNode> Parser::declaration() {
 /*
 DeclarationPrime -> function || varDecl
  * */
-UnqPtr<ASTNode> Parser::declarationPrime(const Token& typeToken, const Token& identifierToken) {
-    Logger::getInstance().debug("Analizando 'declarationPrime' con: " + tokens[current].value);
+ASTNode* Parser::declarationPrime(const Token& typeToken, const Token& identifierToken) {
+    LOG_DEBUG("Analizando 'declarationPrime' con: " + std::string(peek().value));
     if (check(TokenType::LEFT_PARENTHESIS)) return function(typeToken, identifierToken);
     if (check(TokenType::OPERATOR_ASSIGN)) return varDecl(typeToken, identifierToken);
-    Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Se esperaba un '(' o un operador de asignación en lugar de: " + tokens[current].value);
-    synchronize();
+    error("Se esperaba un '(' o un operador de asignación en lugar de: " + std::string(peek().value));
     return nullptr;
 }
 
 /*
 function -> ( params ) { stmtlist }
 */
-UnqPtr<FunctionDeclarationNode> Parser::function(const Token& typeToken, const Token& identifierToken) {
-    Logger::getInstance().debug("Analizando 'function' con: " + tokens[current].value);
-    auto functionNode = std::make_unique<FunctionDeclarationNode>(typeToken, identifierToken, std::vector<UnqPtr<ParamNode>>{}, nullptr);
+FunctionDeclarationNode* Parser::function(const Token& typeToken, const Token& identifierToken) {
+    LOG_DEBUG("Analizando 'function' con: " + std::string(peek().value));
+    auto functionNode = context.Create<FunctionDeclarationNode>(typeToken, identifierToken, std::vector<ParamNode*>{}, nullptr);
     
-    if (match(TokenType::LEFT_PARENTHESIS) && params(functionNode->parameters)) {
-        if (!match(TokenType::RIGHT_PARENTHESIS)) {
-            Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Se esperaba ')' al final de los parámetros.");
-            synchronize();
+    if (!match(TokenType::LEFT_PARENTHESIS)) {
+        error("Se esperaba una declaración de tipo (content)");
+        return nullptr;
+    }
+    if (!params(functionNode->parameters) || !match(TokenType::RIGHT_PARENTHESIS)) {
+        error("Se esperaba ')' al final de los parámetros.");
+        if (!skipToClosingParenthesis()) return nullptr;
+    }
+    if (!match(TokenType::LEFT_BRACE)) {
+        error("Se esperaba '{' al inicio del cuerpo de la función.");
+        return nullptr;
+    }
+
+    if (skeleton && buffer) {
+        // Solo se emparejan llaves; el cuerpo se analiza cuando se pida.
+        size_t begin = tokens.position();
+        if (!tokens.skipBlock()) {
+            error("Se esperaba '}' al final del cuerpo de la función.");
             return nullptr;
         }
-        if (!match(TokenType::LEFT_BRACE)) {
-            Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Se esperaba '{' al inicio del cuerpo de la función.");
-            synchronize();
-            return nullptr;
+        size_t end = tokens.position();
+        if (begin == end) {
+            error("Error en 'statement' dentro de 'stmtList'");
         }
-
+        const TokenBuffer* source = buffer;
+        ASTContext* owner = bodyContext;
+        functionNode->deferredBody = [owner, source, begin, end] { return deferredBody(*owner, *source, begin, end); };
+    } else {
         functionNode->body = stmtList();
-        
-        if (functionNode->body) {
-            if (!match(TokenType::RIGHT_BRACE)) {
-                Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Se esperaba '}' al final del cuerpo de la función.");
-                synchronize();
-                return nullptr;
-            }
-            return functionNode;
-        }
+    }
 
-        Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en la declaración de la función.");
-        // throw std::runtime_error("Error en la declaración de la función.");
+    if (!match(TokenType::RIGHT_BRACE)) {
+        error("Se esperaba '}' al final del cuerpo de la función.");
+        return nullptr;
     }
-    Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Se esperaba una declaración de tipo (content)");
-    synchronize();
-    return nullptr;
+    return functionNode;
+}
+
+// Analiza el cuerpo aplazado de una función: los tokens [begin, end) entre
+// sus llaves. Informa de sus errores y devuelve nullptr si los hubo.
+ASTNode* Parser::deferredBody(ASTContext& context, const TokenBuffer& tokens, size_t begin, size_t end) {
+    Parser part(context, tokens, begin, end);
+    ASTNode* body = part.stmtList();
+    if (!part.isAtEnd()) {
+        part.error("Se esperaba '}' al final del cuerpo de la función.");
+    }
+    part.reportErrors();
+    if (part.failed) return nullptr;
+    return body;
 }
 
 /*
@@ -212,81 +595,72 @@ Params -> Type Identifier Params
 Params -> , Params
 Params -> epsilon
 */
-bool Parser::params(std::vector<UnqPtr<ParamNode>>& parameters) {
-    Logger::getInstance().debug("Analizando 'params' con: " + tokens[current].value);
-    if (type()) {
+bool Parser::params(std::vector<ParamNode*>& parameters) {
+    LOG_DEBUG("Analizando 'params' con: " + std::string(peek().value));
+    while (type()) {
         Token typeToken = previous();
-        if (match(TokenType::IDENTIFIER)) {
-            Token identifierToken = previous();
-            Logger::getInstance().debug("Encontrado parámetro: " + previous().value);
+        if (!match(TokenType::IDENTIFIER)) {
+            error("Se esperaba un identificador después del tipo en 'params'.");
+            return false;
+        }
+        Token identifierToken = previous();
+        LOG_DEBUG("Encontrado parámetro: " + std::string(previous().value));
 
-            parameters.push_back(std::make_unique<ParamNode>(typeToken, identifierToken));
+        parameters.push_back(context.Create<ParamNode>(typeToken, identifierToken));
 
-            if (match(TokenType::COMMA)) {
-                return params(parameters);
-            }
-            return true;
-            /* Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Se esperaban parámetros válidos");
-            synchronize();
-            return false; */
-        }
-        Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Se esperaba un identificador después del tipo en 'params'.");
-        synchronize();
-        //throw std::runtime_error("Se esperaba un identificador después del tipo en 'params'.");
+        if (!match(TokenType::COMMA)) return true;
     }
 
     if (check(TokenType::RIGHT_PARENTHESIS)) {
-        Logger::getInstance().debug("Epsilon encontrado en 'params'");
+        LOG_DEBUG("Epsilon encontrado en 'params'");
         return true;
     }
-    Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'params': token inesperado: " + tokens[current].value);
-    synchronize();
+    error("Error en 'params': token inesperado: " + std::string(peek().value));
     return false;
 }
 
 // VarDecl -> ;
 // VarDecl -> = Expression ;
-UnqPtr<VarDeclarationNode> Parser::varDecl(const Token& typeToken, const Token& identifierToken) {
-    Logger::getInstance().debug("Analizando 'varDecl' con: " + tokens[current].value);
+VarDeclarationNode* Parser::varDecl(const Token& typeToken, const Token& identifierToken) {
+    LOG_DEBUG("Analizando 'varDecl' con: " + std::string(peek().value));
 
-    auto varDeclNode = std::make_unique<VarDeclarationNode>(typeToken, identifierToken);
+    auto varDeclNode = context.Create<VarDeclarationNode>(typeToken, identifierToken);
 
     if (match(TokenType::OPERATOR_ASSIGN)) {
-        Logger::getInstance().debug("Asignación en declaración de variable");
+        LOG_DEBUG("Asignación en declaración de variable");
         varDeclNode->expression = expression();
         if (!varDeclNode->expression) {
-            Logger::getInstance().debug("Se esperaba una expresión después del '=' en 'varDecl'");
-            synchronize();
+            error("Se esperaba una expresión después del '=' en 'varDecl'");
+            return nullptr;
         }
 
         if (!match(TokenType::SEMICOLON)) {
-            Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Se esperaba ';' al final de la declaración.");
-            synchronize();
+            error("Se esperaba ';' al final de la declaración.");
             return nullptr;
         }
-        Logger::getInstance().debug("Declaración de variable con asignación finalizada");
+        LOG_DEBUG("Declaración de variable con asignación finalizada");
         return varDeclNode;
     }
     if (match(TokenType::SEMICOLON)) {
-        Logger::getInstance().debug("Declaración de variable con asignación finalizada");
+        LOG_DEBUG("Declaración de variable con asignación finalizada");
         return varDeclNode;
     }
 
-    Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'varDecl', se esperaba ';' o '='.");
+    error("Error en 'varDecl', se esperaba ';' o '='.");
     return nullptr;
 }
 
 // ExprList -> Expression ExprListPrime
-UnqPtr<ExprListNode> Parser::exprList() {
+ExprListNode* Parser::exprList() {
     
-    auto exprListNode = std::make_unique<ExprListNode>();
-    UnqPtr<ASTNode> exprNode = expression();
-    Logger::getInstance().debug("Analizando 'exprList' con: " + tokens[current].value);
+    auto exprListNode = context.Create<ExprListNode>();
+    ASTNode* exprNode = expression();
+    LOG_DEBUG("Analizando 'exprList' con: " + std::string(peek().value));
     if (!exprNode) {
-        Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'expression' dentro de 'exprList'");
+        error("Error en 'expression' dentro de 'exprList'");
         return nullptr;
     }
-    exprListNode->AddExpression(std::move(exprNode));
+    exprListNode->AddExpression(exprNode);
 
     if (!exprListPrime(exprListNode)) {
         return nullptr;
@@ -296,155 +670,173 @@ UnqPtr<ExprListNode> Parser::exprList() {
 
 // ExprListPrime -> , ExprList
 // ExprListPrime -> epsilon
-bool Parser::exprListPrime(UnqPtr<ExprListNode>& exprListNode) {
-    Logger::getInstance().debug("Analizando 'exprListPrime' con: " + tokens[current].value);
-    if (match(TokenType::COMMA)) {
-        UnqPtr<ASTNode> exprNode = expression();
+bool Parser::exprListPrime(ExprListNode*& exprListNode) {
+    LOG_DEBUG("Analizando 'exprListPrime' con: " + std::string(peek().value));
+    while (match(TokenType::COMMA)) {
+        ASTNode* exprNode = expression();
         if (!exprNode) {
-            Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'exprList' después de ',' en 'exprListPrime'");
+            error("Error en 'exprList' después de ',' en 'exprListPrime'");
             return false;
         }
-        exprListNode->AddExpression(std::move(exprNode));
-        return exprListPrime(exprListNode);
+        exprListNode->AddExpression(exprNode);
     }
     if (check(TokenType::RIGHT_PARENTHESIS)) {
-        Logger::getInstance().debug("Epsilon encontrado en 'exprListPrime'");
+        LOG_DEBUG("Epsilon encontrado en 'exprListPrime'");
         return true;
     }
-    Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'exprListPrime': token inesperado");
+    error("Error en 'exprListPrime': token inesperado");
     return false;
 }
 
-/*  
-Expression -> OrExpr expressionPrime
+/*
+Expression -> OrExpr ExpressionPrime
+ExpressionPrime -> = OrExpr | epsilon
+
+OrExpr, AndExpr, EqExpr, RelExpr, Expr y Term se reconocen todos en
+binaryExpr() por precedencia: cada operador binario tiene un nivel y la
+tabla de niveles dice qué nodo construir y qué mensajes dar.
 */
-UnqPtr<ASTNode> Parser::expression() {
-    Logger::getInstance().debug("Analizando 'expression' con: " + tokens[current].value);
+ASTNode* Parser::expression() {
+    // Paréntesis, índices y argumentos anidados vuelven a entrar aquí.
+    if (Stack::isLow()) return Stack::onNewSegment([this] { return expression(); });
+    LOG_DEBUG("Analizando 'expression' con: " + std::string(peek().value));
 
-    UnqPtr<ASTNode> left = orExpr();
+    ASTNode* left = binaryExpr(Precedence::OR);
     if (!left) return nullptr;
-    return expressionPrime(std::move(left));
-}
-
-/*  
-ExpressionPrime -> epsilon
-ExpressionPrime -> = OrExpr
-*/
-UnqPtr<ASTNode> Parser::expressionPrime(UnqPtr<ASTNode> left) {
-    Logger::getInstance().debug("Analizando 'expressionPrime' con: " + tokens[current].value);
 
     if (match(TokenType::OPERATOR_ASSIGN)) {
-        Logger::getInstance().debug("Se encontró operador de asignación");
-
-        UnqPtr<ASTNode> right = orExpr();
+        LOG_DEBUG("Se encontró operador de asignación");
+        Token op = previous();
+        ASTNode* right = binaryExpr(Precedence::OR);
         if (!right) {
-            Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'orExpr' después de operador de asignación en 'expressionPrime'");
+            error("Error en 'orExpr' después de operador de asignación en 'expressionPrime'");
             return nullptr;
         }
-        return std::make_unique<AssignmentNode>(std::move(left), previous(), std::move(right));;
+        return context.Create<AssignmentNode>(left, op, right);
     }
-    if (check(TokenType::RIGHT_PARENTHESIS) || check(TokenType::RIGHT_BRACKET) ||
-        check(TokenType::COMMA) || check(TokenType::SEMICOLON)) {
-        Logger::getInstance().debug("Epsilon encontrado en 'expressionPrime'");
+    if (checkAny(FOLLOW_EXPRESSION)) {
+        LOG_DEBUG("Epsilon encontrado en 'expressionPrime'");
         return left;
     }
-    Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'expressionPrime': token inesperado");
+    error("Error en 'expressionPrime': token inesperado");
     return nullptr;
 }
 
-/* 
-OrExpr -> AndExpr OrExprPrime
-*/
-UnqPtr<ASTNode> Parser::orExpr() {
-    Logger::getInstance().debug("Analizando 'orExpr' con: " + tokens[current].value);
-    UnqPtr<ASTNode> left = andExpr();
-    if (!left) return nullptr;
-    return orExprPrime(std::move(left));
+namespace {
+
+using Precedence = Parser::Precedence;
+
+constexpr size_t TOKEN_TYPE_COUNT = static_cast<size_t>(TokenType::ERROR) + 1;
+
+// Nivel de cada operador binario; NONE para el resto de tokens.
+constexpr std::array<Precedence, TOKEN_TYPE_COUNT> buildBinaryPrecedence() {
+    std::array<Precedence, TOKEN_TYPE_COUNT> table{};
+    table[static_cast<size_t>(TokenType::OPERATOR_OR)] = Precedence::OR;
+    table[static_cast<size_t>(TokenType::OPERATOR_AND)] = Precedence::AND;
+    table[static_cast<size_t>(TokenType::OPERATOR_EQUAL)] = Precedence::EQUALITY;
+    table[static_cast<size_t>(TokenType::OPERATOR_NOT_EQUAL)] = Precedence::EQUALITY;
+    table[static_cast<size_t>(TokenType::OPERATOR_LESS_THAN)] = Precedence::RELATIONAL;
+    table[static_cast<size_t>(TokenType::OPERATOR_GREATER_THAN)] = Precedence::RELATIONAL;
+    table[static_cast<size_t>(TokenType::OPERATOR_LESS_EQUAL)] = Precedence::RELATIONAL;
+    table[static_cast<size_t>(TokenType::OPERATOR_GREATER_EQUAL)] = Precedence::RELATIONAL;
+    table[static_cast<size_t>(TokenType::OPERATOR_PLUS)] = Precedence::ADDITIVE;
+    table[static_cast<size_t>(TokenType::OPERATOR_MINUS)] = Precedence::ADDITIVE;
+    table[static_cast<size_t>(TokenType::OPERATOR_MULTIPLY)] = Precedence::MULTIPLICATIVE;
+    table[static_cast<size_t>(TokenType::OPERATOR_DIVIDE)] = Precedence::MULTIPLICATIVE;
+    table[static_cast<size_t>(TokenType::OPERATOR_MOD)] = Precedence::MULTIPLICATIVE;
+    return table;
 }
 
-/*
-OrExprPrime -> || AndExpr OrExprPrime
-OrExprPrime -> epsilon
-*/
-UnqPtr<ASTNode> Parser::orExprPrime(UnqPtr<ASTNode> left) {
-    Logger::getInstance().debug("Analizando 'orExprPrime' con: " + tokens[current].value);
-    if (match(TokenType::OPERATOR_OR)) {
-        Logger::getInstance().debug("Encontrado operador '||'");
-        UnqPtr<ASTNode> right = andExpr();
-        if (!right) {
-            Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Se esperaba una expresión después de '||'.");
-            synchronize();
-        }
-        auto logicalOrNode = std::make_unique<LogicalOrNode>(std::move(left), previous(), std::move(right));
-        return orExprPrime(std::move(logicalOrNode));
-    }
-    if (check(TokenType::RIGHT_PARENTHESIS) || check(TokenType::RIGHT_BRACKET) ||
-        check(TokenType::COMMA) || check(TokenType::SEMICOLON) ||
-        check(TokenType::OPERATOR_ASSIGN)) {
-        Logger::getInstance().debug("Epsilon encontrado en 'orExprPrime'");
-        return left;
-    }
+constexpr auto binaryPrecedence = buildBinaryPrecedence();
+
+// Lo que antes hacía cada función *Prime: los tokens que pueden cerrar el
+// nivel, el mensaje si aparece otro, y el mensaje si falta el operando
+// derecho.
+struct BinaryLevel {
+    TokenSet follow;
+    const char* followError;
+    const char* operandError;
+};
+
+constexpr BinaryLevel binaryLevels[] = {
+    {}, // NONE
+    {FOLLOW_OR, "Error en 'orExprPrime': token inesperado",
+     "Se esperaba una expresión después de '||'."},
+    {FOLLOW_AND, "Error en 'andExprPrime': token inesperado",
+     "Se esperaba una expresión después de '&&'."},
+    {FOLLOW_EQUALITY, "Error en 'eqExprPrime': token inesperado",
+     "Error en 'relExpr' después de operador en 'eqExprPrime'"},
+    {FOLLOW_RELATIONAL, "Error en 'relExprPrime': token inesperado",
+     "Error en 'expr' después de operador en 'relExprPrime'"},
+    {FOLLOW_ADDITIVE, "Error en 'exprPrime': token inesperado",
+     "Error en 'term' después de operador en 'exprPrime'"},
+    {FOLLOW_MULTIPLICATIVE, "Error en 'termPrime': token inesperado",
+     "Error en 'unary' después de operador en 'termPrime'"},
+};
+static_assert(std::size(binaryLevels) == static_cast<size_t>(Precedence::MULTIPLICATIVE) + 1,
+              "una entrada de binaryLevels por nivel de precedencia");
+
+const BinaryLevel& levelInfo(Precedence level) {
+    return binaryLevels[static_cast<size_t>(level)];
+}
 
-    Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'orExprPrime': token inesperado");
-    return nullptr;
+ASTNode* makeBinaryNode(ASTContext& context, Precedence level, ASTNode* left, const Token& op, ASTNode* right) {
+    switch (level) {
+        case Precedence::OR: return context.Create<LogicalOrNode>(left, op, right);
+        case Precedence::AND: return context.Create<LogicalAndNode>(left, op, right);
+        case Precedence::EQUALITY: return context.Create<EqualityNode>(left, op, right);
+        case Precedence::RELATIONAL: return context.Create<RelationalNode>(left, op, right);
+        default: return context.Create<BinaryOperationNode>(left, op, right);
+    }
 }
 
-/*
-AndExpr -> EqExpr AndExprPrime
-*/
-UnqPtr<ASTNode> Parser::andExpr() {
-    Logger::getInstance().debug("Analizando 'andExpr' con: " + tokens[current].value);
+}
 
-    UnqPtr<ASTNode> left = eqExpr();
-    if (!left) return nullptr;
-    return andExprPrime(std::move(left));
+Precedence Parser::binaryPrecedenceOf(TokenType type) {
+    return binaryPrecedence[static_cast<size_t>(type)];
 }
 
 /*
-AndExprPrime -> && EqExpr AndExprPrime
-AndExprPrime -> epsilon
+Precedence climbing: reconoce los operadores binarios de nivel >= minimum,
+todos asociativos por la izquierda. El operando derecho de un operador de
+nivel L se analiza con minimum = L + 1, igual que en la gramática
+OrExpr -> AndExpr OrExprPrime, AndExpr -> EqExpr AndExprPrime, etc.
 */
-UnqPtr<ASTNode> Parser::andExprPrime(UnqPtr<ASTNode> left) {
-    Logger::getInstance().debug("Analizando 'andExprPrime' con: " + tokens[current].value);
-    if (match(TokenType::OPERATOR_AND)) {
-        Logger::getInstance().debug("Encontrado operador '&&'");
-        UnqPtr<ASTNode> right = eqExpr();
+ASTNode* Parser::binaryExpr(Precedence minimum) {
+    ASTNode* left = unary();
+    if (!left) return nullptr;
+
+    // Después de construir un nodo de nivel L solo quedan abiertos los niveles <= L.
+    Precedence current = Precedence::MULTIPLICATIVE;
+    while (true) {
+        Precedence level = binaryPrecedenceOf(tokens.peekKind());
+        if (level == Precedence::NONE || level < minimum || level > current) break;
+
+        advance();
+        Token op = previous();
+        LOG_DEBUG("Encontrado operador binario: " + std::string(op.value));
+        const BinaryLevel& info = levelInfo(level);
+
+        ASTNode* right = level == Precedence::MULTIPLICATIVE
+            ? unary()
+            : binaryExpr(static_cast<Precedence>(static_cast<uint8_t>(level) + 1));
         if (!right) {
-            Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Se esperaba una expresión después de '&&'.");
-            synchronize();
-            //throw std::runtime_error("Se esperaba una expresión después de '&&'.");
+            error(info.operandError);
+            return nullptr;
         }
-        auto logicalAndNode = std::make_unique<LogicalAndNode>(std::move(left), previous(), std::move(right));
-        return andExprPrime(std::move(logicalAndNode));
-    }
-    if (check(TokenType::OPERATOR_NOT) || check(TokenType::OPERATOR_MINUS) ||
-        check(TokenType::IDENTIFIER) || check(TokenType::LITERAL_INT) ||
-        check(TokenType::LITERAL_CHAR) || check(TokenType::LITERAL_STRING) ||
-        check(TokenType::KEYWORD_TRUE) || check(TokenType::KEYWORD_FALSE) ||
-        check(TokenType::LEFT_PARENTHESIS) || check(TokenType::OPERATOR_ASSIGN) ||
-        check(TokenType::RIGHT_BRACKET) || check(TokenType::RIGHT_PARENTHESIS) ||
-        check(TokenType::COMMA) || check(TokenType::SEMICOLON ) ||
-        check(TokenType::OPERATOR_OR)) {
-        Logger::getInstance().debug("Epsilon encontrado en 'andExprPrime'");
-        return left;
+        left = makeBinaryNode(context, level, left, op, right);
+        current = level;
     }
 
-    Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'andExprPrime': token inesperado");
-    return nullptr;
-}
-
-/*
-MultOrDivOrMod -> * | / | %
-*/
-bool Parser::multOrDivOrMod() {
-    Logger::getInstance().debug("Analizando 'multOrDivOrMod' con " + tokens[current].value);
-    if (match(TokenType::OPERATOR_MULTIPLY) || 
-        match(TokenType::OPERATOR_DIVIDE) || 
-        match(TokenType::OPERATOR_MOD)) {
-        Logger::getInstance().debug("Operador de multiplicación/división/módulo encontrado");
-        return true;
+    // Los niveles que se cierran aquí comprueban su FOLLOW, del más interno al más externo.
+    for (uint8_t level = static_cast<uint8_t>(current); level >= static_cast<uint8_t>(minimum); level--) {
+        const BinaryLevel& info = binaryLevels[level];
+        if (!checkAny(info.follow)) {
+            error(info.followError);
+            return nullptr;
+        }
     }
-    return false;
+    return left;
 }
 
 /*
@@ -452,116 +844,102 @@ Unary -> ! Unary
 Unary -> - Unary
 Unary -> Factor
 */
-UnqPtr<ASTNode> Parser::unary() {
-    Logger::getInstance().debug("Analizando 'unary' con: " + tokens[current].value);
-    if (match(TokenType::OPERATOR_NOT) || match(TokenType::OPERATOR_MINUS)) {
-        Token op = previous();
-        Logger::getInstance().debug("Encontrado operador unario: " + op.value);
-        UnqPtr<ASTNode> expr =unary();
-        if (!expr) return nullptr;
-        return std::make_unique<UnaryOperationNode>(op, std::move(expr));
-    }
-    return factor();
+ASTNode* Parser::unary() {
+    // Los prefijos se acumulan y se aplican después, del más interno al más externo.
+    std::vector<Token> prefixes;
+    LOG_DEBUG("Analizando 'unary' con: " + std::string(peek().value));
+    while (match(TokenType::OPERATOR_NOT) || match(TokenType::OPERATOR_MINUS)) {
+        prefixes.push_back(previous());
+        LOG_DEBUG("Encontrado operador unario: " + std::string(previous().value));
+        LOG_DEBUG("Analizando 'unary' con: " + std::string(peek().value));
+    }
+    ASTNode* expr = factor();
+    if (!expr) return nullptr;
+    for (auto op = prefixes.rbegin(); op != prefixes.rend(); ++op) {
+        expr = context.Create<UnaryOperationNode>(*op, expr);
+    }
+    return expr;
 }
 
 /* 
  * Factor -> Identifier Parenthesis FactorPrime | Literal FactorPrime | ( Expression ) FactorPrime 
  */
-UnqPtr<ASTNode> Parser::factor() {
-    Logger::getInstance().debug("Analizando 'factor' con: " + tokens[current].value);
+ASTNode* Parser::factor() {
+    LOG_DEBUG("Analizando 'factor' con: " + std::string(peek().value));
     if (literal()) {
-        Logger::getInstance().debug("Encontrado literal: " + previous().value);
+        LOG_DEBUG("Encontrado literal: " + std::string(previous().value));
         Token litToken = previous();
-        auto literalNode = std::make_unique<LiteralNode>(litToken);
-        return factorPrime(std::move(literalNode));
+        auto literalNode = context.Create<LiteralNode>(litToken);
+        return factorPrime(literalNode);
     }
     if (match(TokenType::IDENTIFIER)) {
         Token identifier = previous();
-        Logger::getInstance().debug("Encontrado identificador: " + previous().value);
-        auto identifierNode = std::make_unique<IdentifierNode>(identifier);
+        LOG_DEBUG("Encontrado identificador: " + std::string(previous().value));
+        auto identifierNode = context.Create<IdentifierNode>(identifier);
 
-        UnqPtr<ASTNode> nodeAfterParenthesis = Parenthesis(std::move(identifierNode));
+        ASTNode* nodeAfterParenthesis = Parenthesis(identifierNode);
         if (!nodeAfterParenthesis) return nullptr;
-        return factorPrime(std::move(nodeAfterParenthesis));
+        return factorPrime(nodeAfterParenthesis);
     }
     if (match(TokenType::LEFT_PARENTHESIS)) {
-        Logger::getInstance().debug("Encontrado '('");
-        UnqPtr<ASTNode> exprNode = expression();
+        LOG_DEBUG("Encontrado '('");
+        ASTNode* exprNode = expression();
         if (!exprNode) {
-            Logger::getInstance().debug("Se esperaba una expresión después de '('");
+            error("Se esperaba una expresión después de '('");
             return nullptr;
         }
         if (!match(TokenType::RIGHT_PARENTHESIS)) {
-            Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Se esperaba ')' después de la expresión.");
-            synchronize();
+            error("Se esperaba ')' después de la expresión.");
             return nullptr;
         }
-        return factorPrime(std::move(exprNode));
+        return factorPrime(exprNode);
     }
     return nullptr;
 }
 
 /* Parenthesis -> ( ExprList ) | epsilon */
-UnqPtr<ASTNode> Parser::Parenthesis(UnqPtr<IdentifierNode> identifier) {
-    Logger::getInstance().debug("Analizando 'Parenthesis' con: " + tokens[current].value);
+ASTNode* Parser::Parenthesis(IdentifierNode* identifier) {
+    LOG_DEBUG("Analizando 'Parenthesis' con: " + std::string(peek().value));
     if (match(TokenType::LEFT_PARENTHESIS)) {
-        Logger::getInstance().debug("Encontrado '('");
-        UnqPtr<ExprListNode> arguments = nullptr;
+        LOG_DEBUG("Encontrado '('");
+        ExprListNode* arguments = nullptr;
         if (!check(TokenType::RIGHT_PARENTHESIS)) {
             arguments = exprList();
             if (!arguments) {
-                Logger::getInstance().debug("Se esperaba una exprList después de '('");
+                LOG_DEBUG("Se esperaba una exprList después de '('");
                 return nullptr;
             }
         }
         if (!match(TokenType::RIGHT_PARENTHESIS)) {
-            Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Se esperaba ')' después de la expresión.");
-            synchronize();
+            error("Se esperaba ')' después de la expresión.");
             return nullptr;
         }
-        auto functionCallNode = std::make_unique<FunctionCallNode>(std::move(identifier), std::move(arguments));
+        auto functionCallNode = context.Create<FunctionCallNode>(identifier, arguments);
         return functionCallNode;
     }
-    if (check(TokenType::RIGHT_PARENTHESIS) || check(TokenType::LEFT_BRACKET) ||
-        check(TokenType::RIGHT_BRACKET) || check(TokenType::COMMA) ||
-        check(TokenType::SEMICOLON) || check(TokenType::OPERATOR_ASSIGN) ||
-        check(TokenType::OPERATOR_OR) || check(TokenType::OPERATOR_AND) ||
-        check(TokenType::OPERATOR_EQUAL) || check(TokenType::OPERATOR_NOT_EQUAL) ||
-        check(TokenType::OPERATOR_LESS_THAN) || check(TokenType::OPERATOR_GREATER_THAN) ||
-        check(TokenType::OPERATOR_LESS_EQUAL) || check(TokenType::OPERATOR_GREATER_EQUAL) ||
-        check(TokenType::OPERATOR_PLUS) || check(TokenType::OPERATOR_MINUS) ||
-        check(TokenType::OPERATOR_MULTIPLY) || check(TokenType::OPERATOR_DIVIDE) ||
-        check(TokenType::OPERATOR_MOD)) {
-        Logger::getInstance().debug("Epsilon encontrado en Parenthesis");
+    if (checkAny(FOLLOW_CALLEE)) {
+        LOG_DEBUG("Epsilon encontrado en Parenthesis");
         return identifier;
     }
     return nullptr;
 }
 
 /* FactorPrime -> [ Expression ] FactorPrime | epsilon */
-UnqPtr<ASTNode> Parser::factorPrime(UnqPtr<ASTNode> node) {
-    Logger::getInstance().debug("Analizando 'factorPrime': " + tokens[current].value);
-    if (match(TokenType::LEFT_BRACKET)) {
-        Logger::getInstance().debug("Encontrado '['");
-        UnqPtr<ASTNode> index = expression();
+ASTNode* Parser::factorPrime(ASTNode* node) {
+    LOG_DEBUG("Analizando 'factorPrime': " + std::string(peek().value));
+    while (match(TokenType::LEFT_BRACKET)) {
+        LOG_DEBUG("Encontrado '['");
+        ASTNode* index = expression();
         if (!index) {
-            Logger::getInstance().debug("Se esperaba una expresión después de '['");
+            error("Se esperaba una expresión después de '['");
             return nullptr;  
         }
-        consume(TokenType::RIGHT_BRACKET, "Se esperaba ']' después de la expresión.");
-        auto indexingNode = std::make_unique<IndexingNode>(std::move(node), std::move(index));
-        return factorPrime(std::move(indexingNode));  
-    }
-    if (check(TokenType::RIGHT_PARENTHESIS) || check(TokenType::RIGHT_BRACKET) ||
-        check(TokenType::COMMA) || check(TokenType::SEMICOLON) ||
-        check(TokenType::OPERATOR_ASSIGN) || check(TokenType::OPERATOR_OR) ||
-        check(TokenType::OPERATOR_AND) || check(TokenType::OPERATOR_EQUAL) ||
-        check(TokenType::OPERATOR_NOT_EQUAL) || check(TokenType::OPERATOR_LESS_THAN) ||
-        check(TokenType::OPERATOR_GREATER_THAN) || check(TokenType::OPERATOR_LESS_EQUAL) ||
-        check(TokenType::OPERATOR_GREATER_EQUAL) || check(TokenType::OPERATOR_PLUS) ||
-        check(TokenType::OPERATOR_MINUS) || check(TokenType::OPERATOR_MULTIPLY) ||
-        check(TokenType::OPERATOR_DIVIDE) || check(TokenType::OPERATOR_MOD)) {
-        Logger::getInstance().debug("Epsilon encontrado en factorPrime");
+        if (!consume(TokenType::RIGHT_BRACKET, "Se esperaba ']' después de la expresión.")) return nullptr;
+        node = context.Create<IndexingNode>(node, index);
+        LOG_DEBUG("Analizando 'factorPrime': " + std::string(peek().value));
+    }
+    if (checkAny(FOLLOW_FACTOR)) {
+        LOG_DEBUG("Epsilon encontrado en factorPrime");
         return node;
     }
     return nullptr;  
@@ -570,469 +948,242 @@ UnqPtr<ASTNode> Parser::factorPrime(UnqPtr<ASTNode> node) {
 
 /* Literal -> IntegerLiteral | CharLiteral | BooleanLiteral | StringLiteral */
 bool Parser::literal() {
-    Logger::getInstance().debug("Analizando 'literal' con: " + tokens[current].value);
-    return match(TokenType::LITERAL_INT) ||
-           match(TokenType::LITERAL_CHAR) ||
-           match(TokenType::KEYWORD_FALSE) || match(TokenType::KEYWORD_TRUE) ||
-           match(TokenType::LITERAL_STRING);
-}
-
-/*
-Term -> Unary TermPrime
-*/
-UnqPtr<ASTNode> Parser::term() {
-    Logger::getInstance().debug("Analizando 'term' con: " + tokens[current].value);
-    UnqPtr<ASTNode> left = unary();
-    if (!left) return nullptr;
-    return termPrime(std::move(left));
-}
-
-/*
-TermPrime -> MultOrDivOrMod Unary TermPrime
-TermPrime -> epsilon
-*/
-UnqPtr<ASTNode> Parser::termPrime(UnqPtr<ASTNode> left) {
-    Logger::getInstance().debug("Analizando 'termPrime' con: " + tokens[current].value);
-    if (multOrDivOrMod()) {
-        Logger::getInstance().debug("Encontrado operador de multiplicación/división/módulo");
-
-        Token op = previous();
-        UnqPtr<ASTNode> right = unary();
-        if (!right) {
-            Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'unary' después de operador en 'termPrime'");
-            return nullptr;
-        }
-        auto binOpNode = std::make_unique<BinaryOperationNode>(std::move(left), op, std::move(right));
-        return termPrime(std::move(binOpNode));
-    }
-    if (check(TokenType::RIGHT_PARENTHESIS) || check(TokenType::RIGHT_BRACKET) ||
-        check(TokenType::COMMA) || check(TokenType::SEMICOLON) ||
-        check(TokenType::OPERATOR_ASSIGN) || check(TokenType::OPERATOR_OR) ||
-        check(TokenType::OPERATOR_AND) || check(TokenType::OPERATOR_EQUAL) ||
-        check(TokenType::OPERATOR_NOT_EQUAL) || check(TokenType::OPERATOR_LESS_THAN) ||
-        check(TokenType::OPERATOR_GREATER_THAN) || check(TokenType::OPERATOR_LESS_EQUAL) ||
-        check(TokenType::OPERATOR_GREATER_EQUAL) || check(TokenType::OPERATOR_PLUS) ||
-        check(TokenType::OPERATOR_MINUS)) {
-        Logger::getInstance().debug("Epsilon encontrado en 'termPrime'");
-        return left;
-    }
-
-    Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'termPrime': token inesperado");
-    return nullptr;
-}
-
-/*
-EqualOrDifferent -> ==
-EqualOrDifferent -> !=
-*/
-bool Parser::equalOrDifferent() {
-    Logger::getInstance().debug("Analizando 'equalOrDifferent' con: " + tokens[current].value);
-    if (match(TokenType::OPERATOR_EQUAL)) {
-        Logger::getInstance().debug("Encontrado '=='");
-        return true; 
-    }
-    if (match(TokenType::OPERATOR_NOT_EQUAL)) {
-        Logger::getInstance().debug("Encontrado '!='");
-        return true;
-    }
-    return false;
-}
-
-/*
-EqExpr -> RelExpr EqExprPrime
-*/
-UnqPtr<ASTNode> Parser::eqExpr() {
-    Logger::getInstance().debug("Analizando 'eqExpr' con:" + tokens[current].value);
-
-    UnqPtr<ASTNode> left = relExpr();
-
-    if (!left) return nullptr;
-    return eqExprPrime(std::move(left));
-}
-
-/*
-EqExprPrime -> EqualOrDifferent RelExpr EqExprPrime
-EqExprPrime -> epsilon
-*/
-UnqPtr<ASTNode> Parser::eqExprPrime(UnqPtr<ASTNode> left) {
-    Logger::getInstance().debug("Analizando 'eqExprPrime' con: " + tokens[current].value);
-
-    if (equalOrDifferent()) {
-        Logger::getInstance().debug("Encontrado operador de igualdad/desigualdad");
-        Token op = previous();
-        UnqPtr<ASTNode> right = relExpr();
-        if (!right) {
-            Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'relExpr' después de operador en 'eqExprPrime'");
-            return nullptr;
-        }
-        auto equalityNode = std::make_unique<EqualityNode>(std::move(left), op, std::move(right));
-
-        return eqExprPrime(std::move(equalityNode));
-    }
-    if (check(TokenType::RIGHT_PARENTHESIS) || check(TokenType::RIGHT_BRACKET) ||
-        check(TokenType::OPERATOR_ASSIGN) || check(TokenType::OPERATOR_OR) ||
-        check(TokenType::COMMA) || check(TokenType::SEMICOLON) ||
-        check(TokenType::OPERATOR_AND)) {
-        Logger::getInstance().debug("Epsilon encontrado en 'eqExprPrime'");
-        return left;
-    }
-    Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'eqExprPrime': token inesperado");
-    return nullptr;
-}
-
-/*
-GreaterOrLess -> <
-GreaterOrLess -> >
-GreaterOrLess -> <=
-GreaterOrLess -> >=
-*/
-bool Parser::greaterOrLess() {
-    Logger::getInstance().debug("Analizando 'greaterOrLess' con: " + tokens[current].value);
-    if (match(TokenType::OPERATOR_LESS_THAN) ||
-        match(TokenType::OPERATOR_GREATER_THAN) ||
-        match(TokenType::OPERATOR_LESS_EQUAL) ||
-        match(TokenType::OPERATOR_GREATER_EQUAL)) {
-        return true;
-    }
-    return false;
-}
-
-/*
-RelExpr -> Expr RelExprPrime
-*/
-UnqPtr<ASTNode> Parser::relExpr() {
-    Logger::getInstance().debug("Analizando 'relExpr'");
-
-    UnqPtr<ASTNode> left = expr();
-    if (!left) return  nullptr;
-    return relExprPrime(std::move(left));
-}
-
-/*
-RelExprPrime -> GreaterOrLess Expr RelExprPrime
-RelExprPrime -> epsilon
-*/
-UnqPtr<ASTNode> Parser::relExprPrime(UnqPtr<ASTNode> left) {
-    Logger::getInstance().debug("Analizando 'relExprPrime'");
-    if (greaterOrLess()) {
-        Logger::getInstance().debug("Encontrado operador de comparación");
-        Token op = previous();
-
-        UnqPtr<ASTNode> right = expr();
-        if (!right) {
-            Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'expr' después de operador en 'relExprPrime'");
-            return nullptr;
-        }
-
-        auto relationalNode = std::make_unique<RelationalNode>(std::move(left), op, std::move(right));
-        return relExprPrime(std::move(relationalNode));
-    }
-    if (check(TokenType::RIGHT_PARENTHESIS) || check(TokenType::RIGHT_BRACKET) ||
-        check(TokenType::COMMA) || check(TokenType::SEMICOLON) ||
-        check(TokenType::OPERATOR_ASSIGN) || check(TokenType::OPERATOR_OR) ||
-        check(TokenType::OPERATOR_AND) || check(TokenType::OPERATOR_EQUAL) ||
-        check(TokenType::OPERATOR_NOT_EQUAL)) {
-        Logger::getInstance().debug("Epsilon encontrado en 'relExprPrime'");
-        return left;
-    }
-
-    Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'relExprPrime': token inesperado");
-    return nullptr;
-}
-
-/*
-SumOrRest -> +
-SumOrRest -> -
-*/
-bool Parser::sumOrRest() {
-    Logger::getInstance().debug("Analizando 'sumOrRest'");
-    if (match(TokenType::OPERATOR_PLUS) || match(TokenType::OPERATOR_MINUS)) {
-        return true;
-    }
-    return false;
-}
-
-/*
-Expr -> Term ExprPrime
-*/
-UnqPtr<ASTNode> Parser::expr() {
-    Logger::getInstance().debug("Analizando 'expr' con: " + tokens[current].value);
-    UnqPtr<ASTNode> left = term();
-    if (!left) return nullptr;
-    return exprPrime(std::move(left));
-}
-
-/*
-ExprPrime -> SumOrRest Term ExprPrime
-ExprPrime -> epsilon
-*/
-UnqPtr<ASTNode> Parser::exprPrime(UnqPtr<ASTNode> left) {
-    Logger::getInstance().debug("Analizando 'exprPrime'");
-    if (sumOrRest()) {
-        Logger::getInstance().debug("Encontrado operador de suma/resta");
-        Token op = previous();
-        UnqPtr<ASTNode> right = term();
-        if (!right) {
-            Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'term' después de operador en 'exprPrime'");
-            return nullptr;
-        }
-        auto binOpNode = std::make_unique<BinaryOperationNode>(std::move(left), op, std::move(right));
-        return exprPrime(std::move(binOpNode));
-    }
-    if (check(TokenType::RIGHT_PARENTHESIS) || check(TokenType::RIGHT_BRACKET) ||
-        check(TokenType::COMMA) || check(TokenType::SEMICOLON) ||
-        check(TokenType::OPERATOR_ASSIGN) || check(TokenType::OPERATOR_OR) ||
-        check(TokenType::OPERATOR_AND) || check(TokenType::OPERATOR_EQUAL) ||
-        check(TokenType::OPERATOR_NOT_EQUAL) || check(TokenType::OPERATOR_LESS_THAN) ||
-        check(TokenType::OPERATOR_GREATER_THAN) || check(TokenType::OPERATOR_LESS_EQUAL) ||
-        check(TokenType::OPERATOR_GREATER_EQUAL)) {
-        Logger::getInstance().debug("Epsilon encontrado en 'exprPrime'");
-        return left;
-    }
-    Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'exprPrime': token inesperado");
-    return nullptr;
+    LOG_DEBUG("Analizando 'literal' con: " + std::string(peek().value));
+    return matchAny(LITERALS);
 }
 
 // Statement -> VarDecl | IfStmt | ForStmt | ReturnStmt | ExprStmt | PrintStmt | {StmtList}
-UnqPtr<ASTNode> Parser::statement() {
-    Logger::getInstance().debug("Analizando 'statement' con: " + tokens[current].value);
-    if (type()) {
-        Token typeToken = previous();
-        if (match(TokenType::IDENTIFIER)) {
+// El token actual decide la alternativa.
+ASTNode* Parser::statement() {
+    // Bloques y cuerpos de 'for' anidados vuelven a entrar aquí.
+    if (Stack::isLow()) return Stack::onNewSegment([this] { return statement(); });
+    LOG_DEBUG("Analizando 'statement' con: " + std::string(peek().value));
+    switch (tokens.peekKind()) {
+        case TokenType::KEYWORD_INTEGER:
+        case TokenType::KEYWORD_BOOLEAN:
+        case TokenType::KEYWORD_CHAR:
+        case TokenType::KEYWORD_STRING:
+        case TokenType::KEYWORD_VOID: {
+            if (!type()) return nullptr;
+            Token typeToken = previous();
+            if (!match(TokenType::IDENTIFIER)) {
+                error("Se esperaba un identificador después del tipo en 'statement'.");
+                return nullptr;
+            }
             Token idToken = previous();
-            Logger::getInstance().debug("Encontrado identificador en 'statement': " + previous().value);
+            LOG_DEBUG("Encontrado identificador en 'statement': " + std::string(previous().value));
             return varDecl(typeToken, idToken);
         }
-    } else if (UnqPtr<ASTNode> ifNode = ifStmt()) {
-        return ifNode;
-    } else if (UnqPtr<ASTNode> forNode = forStmt()) {
-        return forNode;
-    } else if (UnqPtr<ASTNode> returnNode = returnStmt()) {
-        return returnNode;
-    } else if (UnqPtr<ASTNode> printNode = printStmt()) {
-        return printNode;
-    } else if (UnqPtr<ASTNode> exprStmtNode = exprStmt()) {
-        return exprStmtNode;
-    } else if (match(TokenType::LEFT_BRACE)) {
-        UnqPtr<ASTNode> blockNode = stmtList();
-        if (!blockNode) {
-            Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Se espera stmtList despues de { en 'statement'");
-            return nullptr;
+        case TokenType::KEYWORD_IF:
+            return ifStmt();
+        case TokenType::KEYWORD_FOR:
+            return forStmt();
+        case TokenType::KEYWORD_RETURN:
+            return returnStmt();
+        case TokenType::KEYWORD_PRINT:
+            return printStmt();
+        case TokenType::LEFT_BRACE: {
+            advance();
+            ASTNode* blockNode = stmtList();
+            if (!consume(TokenType::RIGHT_BRACE, "Se espera } despues de stmtList")) return nullptr;
+            return blockNode;
         }
-        consume(TokenType::RIGHT_BRACE, "Se espera } despues de stmtList");
-        return blockNode;
+        default:
+            return exprStmt();
     }
-
-    Logger::getInstance().debug("Ninguna coincidencia encontrada en 'statement'");
-    return nullptr;
 }
 
 // IfStmt -> if ( Expression ) { Statement } ifStmtPrime
-UnqPtr<ASTNode> Parser::ifStmt() {
-    Logger::getInstance().debug("Analizando 'ifStmt'");
+ASTNode* Parser::ifStmt() {
+    LOG_DEBUG("Analizando 'ifStmt'");
     if (!match(TokenType::KEYWORD_IF)) {
         return nullptr;
     }
-    Logger::getInstance().debug("Analizando 'ifStmt' - IF ENCONTRADO");
+    LOG_DEBUG("Analizando 'ifStmt' - IF ENCONTRADO");
 
-    consume(TokenType::LEFT_PARENTHESIS, "Se esperaba '(' después de 'if'.");
+    if (!consume(TokenType::LEFT_PARENTHESIS, "Se esperaba '(' después de 'if'.")) return nullptr;
 
-    UnqPtr<ASTNode> condition = expression();
+    ASTNode* condition = expression();
     if (!condition) {
-        Logger::getInstance().debug("Se esperaba una expresión dentro del 'if'.");
+        error("Se esperaba una expresión dentro del 'if'.");
     }
 
-    consume(TokenType::RIGHT_PARENTHESIS, "Se esperaba ')' después de la expresión.");
-
-    Logger::getInstance().debug("Analizando 'ifStmt' - ENCONTRADA CONDICIÓN ENTRE PARENTESIS");
+    if (!condition || !consume(TokenType::RIGHT_PARENTHESIS, "Se esperaba ')' después de la expresión.")) {
+        if (!skipToClosingParenthesis()) return nullptr;
+    }
 
-    consume(TokenType::LEFT_BRACE, "Se esperaba '{' después de la expresión.");
+    LOG_DEBUG("Analizando 'ifStmt' - ENCONTRADA CONDICIÓN ENTRE PARENTESIS");
 
-    UnqPtr<ASTNode> ifBody = stmtList();
+    if (!consume(TokenType::LEFT_BRACE, "Se esperaba '{' después de la expresión.")) return nullptr;
 
-    if (!ifBody) {
-        Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'statement' dentro de 'ifStmt'");
-        return nullptr;
-    }
+    ASTNode* ifBody = stmtList();
 
-    consume(TokenType::RIGHT_BRACE, "Se esperaba '}' después del bloque de 'if'.");
-    Logger::getInstance().debug("Analizando 'ifStmt' - ENCONTRADO BLOQUE ENTRE CORCHETES");
+    if (!consume(TokenType::RIGHT_BRACE, "Se esperaba '}' después del bloque de 'if'.")) return nullptr;
+    LOG_DEBUG("Analizando 'ifStmt' - ENCONTRADO BLOQUE ENTRE CORCHETES");
 
-    UnqPtr<ASTNode> elseBody = ifStmtPrime();
-    return std::make_unique<IfStatementNode>(std::move(condition), std::move(ifBody), std::move(elseBody));
+    ASTNode* elseBody = ifStmtPrime();
+    return context.Create<IfStatementNode>(condition, ifBody, elseBody);
 }
 
 // IfStmtPrime -> else { Statement } | epsilon
-UnqPtr<ASTNode> Parser::ifStmtPrime() {
-    Logger::getInstance().debug("Analizando 'ifStmtPrime' con: " + tokens[current].value);
+ASTNode* Parser::ifStmtPrime() {
+    LOG_DEBUG("Analizando 'ifStmtPrime' con: " + std::string(peek().value));
     if (match(TokenType::KEYWORD_ELSE)) {
-        Logger::getInstance().debug("Encontrado 'else'");
-        consume(TokenType::LEFT_BRACE, "Se esperaba '{' después de 'else'.");
+        LOG_DEBUG("Encontrado 'else'");
+        if (!consume(TokenType::LEFT_BRACE, "Se esperaba '{' después de 'else'.")) return nullptr;
 
-        UnqPtr<ASTNode> elseBody = stmtList();
-        if (!elseBody) {
-            Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'statement' dentro de 'ifStmtPrime'");
-            return nullptr;
-        }
-        consume(TokenType::RIGHT_BRACE, "Se esperaba '}' después del bloque de 'else'.");
-        return std::move(elseBody);
-    }
-    if (check(TokenType::RIGHT_BRACE) || check(TokenType::LEFT_BRACE) ||
-        check(TokenType::KEYWORD_INTEGER) || check(TokenType::KEYWORD_BOOLEAN) ||
-        check(TokenType::KEYWORD_CHAR) || check(TokenType::KEYWORD_STRING) ||
-        check(TokenType::KEYWORD_VOID) || check(TokenType::KEYWORD_FOR) ||
-        check(TokenType::KEYWORD_IF) || check(TokenType::KEYWORD_RETURN) ||
-        check(TokenType::KEYWORD_PRINT) || check(TokenType::SEMICOLON) ||
-        check(TokenType::OPERATOR_NOT) || check(TokenType::OPERATOR_MINUS) ||
-        check(TokenType::IDENTIFIER) || check(TokenType::LITERAL_INT) ||
-        check(TokenType::LITERAL_CHAR) || check(TokenType::LITERAL_STRING) ||
-        check(TokenType::KEYWORD_TRUE) || check(TokenType::KEYWORD_FALSE) ||
-        check(TokenType::LEFT_PARENTHESIS)) {
-        Logger::getInstance().debug("Epsilon encontrado en 'ifStmtPrime' - NO SE ENCONTRÓ ELSE");
-        Logger::getInstance().debug("Epsilon encontrado en 'ifStmtPrime'");
+        ASTNode* elseBody = stmtList();
+        if (!consume(TokenType::RIGHT_BRACE, "Se esperaba '}' después del bloque de 'else'.")) return nullptr;
+        return elseBody;
+    }
+    if (checkAny(FOLLOW_IF)) {
+        LOG_DEBUG("Epsilon encontrado en 'ifStmtPrime' - NO SE ENCONTRÓ ELSE");
+        LOG_DEBUG("Epsilon encontrado en 'ifStmtPrime'");
         return nullptr;
     }
 
-    Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'ifStmtPrime': token inesperado");
+    error("Error en 'ifStmtPrime': token inesperado");
     return nullptr;
 }
 
 // ForStmt -> for ( ExprStmt Expression ; ExprStmt ) Statement
-UnqPtr<ASTNode> Parser::forStmt() {
-    Logger::getInstance().debug("Analizando 'forStmt': " + tokens[current].value);
+ASTNode* Parser::forStmt() {
+    LOG_DEBUG("Analizando 'forStmt': " + std::string(peek().value));
     if (!match(TokenType::KEYWORD_FOR)) {
         return nullptr;
     }
 
-    consume(TokenType::LEFT_PARENTHESIS, "Se esperaba '(' después de 'for'.");
+    if (!consume(TokenType::LEFT_PARENTHESIS, "Se esperaba '(' después de 'for'.")) return nullptr;
+
+    ASTNode* init = nullptr;
+    ASTNode* condition = nullptr;
+    ASTNode* increment = nullptr;
+    if (!forHeader(init, condition, increment)) {
+        if (!skipToClosingParenthesis()) return nullptr;
+    }
 
-    Logger::getInstance().debug("TEST1");
+    ASTNode* body = statement();
+    if (!body) {
+        error("Error en 'statement' después del 'for'.");
+        return nullptr;
+    }
 
-    UnqPtr<ASTNode> init = exprStmt();
+    return context.Create<ForStatementNode>(init, condition, increment, body);
+}
 
-    Logger::getInstance().debug("TEST2");
+// ExprStmt Expression ; ExprStmt ) de la cabecera de un 'for'.
+bool Parser::forHeader(ASTNode*& init, ASTNode*& condition, ASTNode*& increment) {
+    init = exprStmt();
     if (!init) {
-        Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'exprStmt' dentro de 'forStmt'");
-        return nullptr;
+        error("Error en 'exprStmt' dentro de 'forStmt'");
+        return false;
     }
-    
-    UnqPtr<ASTNode> condition = expression();
+
+    condition = expression();
     if (!condition) {
-        Logger::getInstance().debug("Se esperaba una expresión en la condición del 'for'.");
-        synchronize();
+        error("Se esperaba una expresión en la condición del 'for'.");
+        return false;
     }
 
     if (!match(TokenType::SEMICOLON)) {
-        Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Se esperaba ';' después de la condición del 'for'.");
-        synchronize();
-        return nullptr;
+        error("Se esperaba ';' después de la condición del 'for'.");
+        return false;
     }
 
-    UnqPtr<ASTNode> increment = exprStmt();
+    increment = exprStmt();
     if (!increment) {
-        Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'exprStmt' después de ';' en 'forStmt'");
-        return nullptr;
-    }
-
-    consume(TokenType::RIGHT_PARENTHESIS, "Se esperaba ')' después de la condición del 'for'.");
-
-
-    UnqPtr<ASTNode> body = statement();
-    if (!body) {
-      Logger::getInstance().debug("Error en 'statement' después del 'for'.");
-      return nullptr;
+        error("Error en 'exprStmt' después de ';' en 'forStmt'");
+        return false;
     }
 
-    return std::make_unique<ForStatementNode>(std::move(init), std::move(condition), std::move(increment), std::move(body));;
+    return consume(TokenType::RIGHT_PARENTHESIS, "Se esperaba ')' después de la condición del 'for'.");
 }
 
 // ReturnStmt -> return Expression ;
-UnqPtr<ASTNode> Parser::returnStmt() {
-    Logger::getInstance().debug("Analizando 'returnStmt'");
+ASTNode* Parser::returnStmt() {
+    LOG_DEBUG("Analizando 'returnStmt'");
     if (!match(TokenType::KEYWORD_RETURN)) {
         return nullptr;
     }
     
-    UnqPtr<ASTNode> returnExpr = expression();
+    ASTNode* returnExpr = expression();
     if (!returnExpr) {
-        Logger::getInstance().debug("Se esperaba una expresión después de 'return'.");
-        synchronize();
-        // throw std::runtime_error("Se esperaba una expresión después de 'return'.");
+        error("Se esperaba una expresión después de 'return'.");
+        return nullptr;
     }
 
     if (!match(TokenType::SEMICOLON)) {
-        Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Se esperaba una expresión despues de 'return'");
+        error("Se esperaba ';' después de la expresión de 'return'.");
         return nullptr;
     }
-    return std::make_unique<ReturnStatementNode>(std::move(returnExpr));
+    return context.Create<ReturnStatementNode>(returnExpr);
 }
 
 // PrintStmt -> print ( ExprList ) ;
-UnqPtr<ASTNode> Parser::printStmt() {
-    Logger::getInstance().debug("Analizando 'printStmt'");
+ASTNode* Parser::printStmt() {
+    LOG_DEBUG("Analizando 'printStmt'");
     if (!match(TokenType::KEYWORD_PRINT)) {
         return nullptr;
     }
 
-    consume(TokenType::LEFT_PARENTHESIS, "Se esperaba '(' después de 'print'.");
+    if (!consume(TokenType::LEFT_PARENTHESIS, "Se esperaba '(' después de 'print'.")) return nullptr;
 
-    UnqPtr<ExprListNode> exprListNode = exprList();
+    ExprListNode* exprListNode = exprList();
     if (!exprListNode) {
-        Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'exprList' dentro de 'printStmt'");
+        error("Error en 'exprList' dentro de 'printStmt'");
         return nullptr;
     }
 
-    consume(TokenType::RIGHT_PARENTHESIS, "Se esperaba ')' después de la lista de expresiones.");
-    consume(TokenType::SEMICOLON, "Se esperaba ';' después de la instrucción 'print'.");
-    return std::make_unique<PrintStatementNode>(std::move(exprListNode));;
+    if (!consume(TokenType::RIGHT_PARENTHESIS, "Se esperaba ')' después de la lista de expresiones.")) return nullptr;
+    if (!consume(TokenType::SEMICOLON, "Se esperaba ';' después de la instrucción 'print'.")) return nullptr;
+    return context.Create<PrintStatementNode>(exprListNode);
 }
 
 // ExprStmt -> ; | Expression ;
-UnqPtr<ASTNode> Parser::exprStmt() {
-    Logger::getInstance().debug("Analizando 'exprStmt'");
+ASTNode* Parser::exprStmt() {
+    LOG_DEBUG("Analizando 'exprStmt'");
     if (match(TokenType::SEMICOLON)) {
-        Logger::getInstance().debug("Encontrado ';' en 'exprStmt'");
-        return std::make_unique<ExpressionStatementNode>(nullptr);
+        LOG_DEBUG("Encontrado ';' en 'exprStmt'");
+        return context.Create<ExpressionStatementNode>(nullptr);
     }
-    UnqPtr<ASTNode> exprNode = expression();
+    ASTNode* exprNode = expression();
     if (!exprNode) return nullptr;
 
-    consume(TokenType::SEMICOLON, "Se esperaba ';' después de la expresión.");
-    return std::make_unique<ExpressionStatementNode>(std::move(exprNode));
+    if (!consume(TokenType::SEMICOLON, "Se esperaba ';' después de la expresión.")) return nullptr;
+    return context.Create<ExpressionStatementNode>(exprNode);
 }
 
 // StmtList -> Statement StmtListPrime
-UnqPtr<ASTNode> Parser::stmtList() {
-    Logger::getInstance().debug("Analizando 'stmtList'");
-    auto compoundNode = std::make_unique<CompoundStatementNode>();
-    UnqPtr<ASTNode> stmtNode = statement();
-    if (!stmtNode) {
-        Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'statement' dentro de 'stmtList'");
-        return nullptr;
+// Siempre devuelve el bloque: los errores de sus sentencias ya quedaron
+// registrados y el análisis sigue en la sentencia siguiente.
+ASTNode* Parser::stmtList() {
+    LOG_DEBUG("Analizando 'stmtList'");
+    auto compoundNode = context.Create<CompoundStatementNode>();
+    if (check(TokenType::RIGHT_BRACE)) {
+        error("Error en 'statement' dentro de 'stmtList'");
     }
-    compoundNode->AddStatement(std::move(stmtNode));
-    if (!stmtListPrime(compoundNode)) return nullptr;
-
+    stmtListPrime(*compoundNode);
     return compoundNode;
 }
 
 // stmtlistprime -> statement stmtlistprime | epsilon
-bool Parser::stmtListPrime(UnqPtr<CompoundStatementNode>& compoundNode) {
-    Logger::getInstance().debug("Analizando 'stmtListPrime'");
-
-    UnqPtr<ASTNode> stmtNode = statement();
-    if (stmtNode) {
-        Logger::getInstance().debug("Encontrado 'statement' en 'stmtListPrime'");
-        compoundNode->AddStatement(std::move(stmtNode));
-        return stmtListPrime(compoundNode);
-    }
-    if (check(TokenType::RIGHT_BRACE)) {
-        Logger::getInstance().debug("Epsilon encontrado en 'stmtListPrime'");
-        return true;
+// Una sentencia con errores se salta hasta un punto seguro y se sigue con la
+// siguiente; el bloque termina en su '}' o al final del archivo.
+void Parser::stmtListPrime(CompoundStatementNode& compoundNode) {
+    LOG_DEBUG("Analizando 'stmtListPrime'");
+
+    while (!check(TokenType::RIGHT_BRACE) && !isAtEnd()) {
+        ASTNode* stmtNode = statement();
+        if (stmtNode) {
+            LOG_DEBUG("Encontrado 'statement' en 'stmtListPrime'");
+            compoundNode.AddStatement(stmtNode);
+            panicMode = false;
+            continue;
+        }
+        error("Error en 'stmtListPrime': token inesperado");
+        synchronize(STATEMENT_ANCHORS);
     }
-
-    Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'stmtListPrime': token inesperado");
-    return false;
+    LOG_DEBUG("Epsilon encontrado en 'stmtListPrime'");
 }
 
 /* Type -> IntType TypePrime
@@ -1041,44 +1192,30 @@ Type -> CharType TypePrime
 Type -> StringType TypePrime
 Type -> Void TypePrime */
 bool Parser::type() {
-    Logger::getInstance().debug("Analizando 'type'");
-    if (match(TokenType::KEYWORD_INTEGER) || 
-        match(TokenType::KEYWORD_BOOLEAN) ||
-        match(TokenType::KEYWORD_CHAR) ||
-        match(TokenType::KEYWORD_STRING) ||
-        match(TokenType::KEYWORD_VOID)) {
-        Logger::getInstance().debug("Encontrado tipo: " + previous().value);
+    LOG_DEBUG("Analizando 'type'");
+    if (matchAny(TYPES)) {
+        LOG_DEBUG("Encontrado tipo: " + std::string(previous().value));
         return typePrime();
     }
 
-    Logger::getInstance().debug("No se encontró un tipo válido en 'type'");
+    LOG_DEBUG("No se encontró un tipo válido en 'type'");
     return false;
 }
 
 // TypePrime -> [] TypePrime
 bool Parser::typePrime() {
-    Logger::getInstance().debug("Analizando 'typePrime'");
-    if (match(TokenType::LEFT_BRACKET)) {
-        Logger::getInstance().debug("Encontrado '[' en 'typePrime'");
-        consume(TokenType::RIGHT_BRACKET, "Se esperaba ']' después de '['.");
-        return typePrime();
+    LOG_DEBUG("Analizando 'typePrime'");
+    while (match(TokenType::LEFT_BRACKET)) {
+        LOG_DEBUG("Encontrado '[' en 'typePrime'");
+        if (!consume(TokenType::RIGHT_BRACKET, "Se esperaba ']' después de '['.")) return false;
+        LOG_DEBUG("Analizando 'typePrime'");
     }
 
     if (check(TokenType::IDENTIFIER)) {
-        Logger::getInstance().debug("'typePrime' encontrado epsilon -> IDENTIFIER");
+        LOG_DEBUG("'typePrime' encontrado epsilon -> IDENTIFIER");
         return true;
     }
 
-    Logger::getInstance().error("Line " + std::to_string(tokens[current].line ) + " " + "Error en 'typePrime', no se encontró un token válido.");
+    error("Error en 'typePrime', no se encontró un token válido.");
     return false;
 }
-
-// Auxiliar function para verificar el inicio de una declaración
-bool Parser::checkForDeclarationStart() {
-    Logger::getInstance().debug("Verificando inicio de una declaración");
-    return check(TokenType::KEYWORD_INTEGER) ||
-           check(TokenType::KEYWORD_BOOLEAN) ||
-           check(TokenType::KEYWORD_CHAR) ||
-           check(TokenType::KEYWORD_STRING) ||
-           check(TokenType::KEYWORD_VOID);
-}
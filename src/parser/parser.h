@@ -1,81 +1,139 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <cstdint>
+#include <string>
 #include <vector>
 #include "../scanner/token.h"
+#include "../scanner/tokenstream.h"
 #include "../utils/logger.h"
 #include "../AST/AST.h"
 
+// Un error de sintaxis: la línea donde se detectó y el mensaje.
+struct SyntaxError {
+    int line;
+    std::string message;
+};
+
 class Parser {
 public:
-    Parser(const std::vector<Token>& tokens);
+    // Niveles de los operadores binarios, de menor a mayor precedencia.
+    enum class Precedence : uint8_t {
+        NONE,
+        OR,             // ||
+        AND,            // &&
+        EQUALITY,       // == !=
+        RELATIONAL,     // < > <= >=
+        ADDITIVE,       // + -
+        MULTIPLICATIVE, // * / %
+    };
+
+    // Los nodos se crean en `context`, que debe vivir tanto como el AST.
+    Parser(ASTContext& context, const TokenBuffer& tokens);
+    // Pulls tokens from the scanner while parsing instead of scanning first.
+    Parser(ASTContext& context, Scanner& scanner);
     bool parse();
-    UnqPtr<ProgramNode> getAST();
+    // Igual que parse(), pero las declaraciones de nivel superior se analizan
+    // en paralelo (0 = un hilo por núcleo). Solo con un TokenBuffer ya escaneado;
+    // con un Scanner analiza secuencialmente.
+    bool parseParallel(unsigned threadCount = 0);
+    // Reanaliza tras editar el fuente. `previous` es el AST de un análisis
+    // anterior sin errores, creado en el mismo ASTContext, y `edits` las
+    // ediciones que llevan de aquel texto al de este TokenBuffer (ver
+    // Scanner::relex). Solo se analizan las declaraciones que tocan las
+    // ediciones; las demás pasan tal cual al AST nuevo. Sus tokens siguen
+    // apuntando a la versión anterior del fuente, y sus cuerpos aplazados al
+    // TokenBuffer anterior, que debe seguir vivo. Las declaraciones
+    // descartadas ocupan el contexto hasta que se destruye.
+    bool reparse(ProgramNode* previous, const std::vector<SourceEdit>& edits);
+    // Modo esqueleto: los cuerpos de las funciones se saltan emparejando
+    // llaves y se analizan la primera vez que se piden con
+    // FunctionDeclarationNode::Body(). Los errores de un cuerpo se informan
+    // entonces. Solo con un TokenBuffer, que debe vivir tanto como el AST.
+    void setSkeleton(bool enabled) { skeleton = enabled; }
+    // Compilación en streaming: analiza solo la siguiente declaración de
+    // nivel superior, sin construir el ProgramNode. Devuelve false al final
+    // del archivo; `declaration` queda vacío si tenía errores, que se
+    // informan en el momento. Con un Scanner, y vaciando el ASTContext
+    // después de cada declaración, ni los tokens ni el AST ocupan más memoria
+    // que la de una declaración.
+    bool parseDeclaration(ASTNode*& declaration);
+    ProgramNode* getAST();
+    // Todos los errores encontrados, en orden. El análisis sigue después de
+    // cada uno, así que una sola pasada los informa todos.
+    const std::vector<SyntaxError>& getErrors() const { return errors; }
 
 private:
-    std::vector<Token> tokens;
-    UnqPtr<ASTNode> root;
+    // Por debajo de tantos tokens no compensa repartir el análisis entre hilos.
+    static constexpr size_t MIN_PARALLEL_TOKENS = 64 * 1024;
+
+    // Analiza solo los tokens [begin, end) del buffer, para parseParallel().
+    Parser(ASTContext& context, const TokenBuffer& tokens, size_t begin, size_t end);
+
+    ASTContext& context;
+    // Donde se crean los cuerpos aplazados: el propio contexto, salvo en los
+    // hilos de parseParallel(), cuyos contextos se juntan al terminar.
+    ASTContext* bodyContext;
+    TokenStream tokens;
+    const TokenBuffer* buffer = nullptr; // solo al reanalizar un buffer ya escaneado
+    ProgramNode* root = nullptr;
 
-    int current;
+    bool skeleton = false;
     bool failed = false;
+    // Modo pánico: desde un error hasta la siguiente recuperación no se
+    // informan más errores.
+    bool panicMode = false;
+    std::vector<SyntaxError> errors;
 
     bool isAtEnd();
-    Token peek();
-    Token advance();
-    Token previous();
+    const Token& peek();
+    const Token& advance();
+    const Token& previous();
     bool match(TokenType type);
     bool check(TokenType type);
-    UnqPtr<ASTNode> consume(TokenType type, const std::string& message);
+    bool checkAny(TokenSet types);
+    bool matchAny(TokenSet types);
+    bool consume(TokenType type, const std::string& message);
 
     // Recuperación de errores
-    void synchronize();
+    void synchronize(TokenSet anchors);
+    bool skipToClosingParenthesis();
     void error(const std::string& message);
+    void reportErrors();
+    bool finish();
 
-    UnqPtr<ProgramNode> program();
-    bool programPrime();
-    UnqPtr<ExprListNode> exprList();
-    bool exprListPrime(UnqPtr<ExprListNode>& exprListNode);
-    UnqPtr<ASTNode> expression();
-    UnqPtr<ASTNode> expressionPrime(UnqPtr<ASTNode> left);
-    UnqPtr<ASTNode> orExpr();
-    UnqPtr<ASTNode> orExprPrime(UnqPtr<ASTNode> left);
-    UnqPtr<ASTNode> andExpr();
-    UnqPtr<ASTNode> andExprPrime(UnqPtr<ASTNode> left);
-    bool multOrDivOrMod();
-    UnqPtr<ASTNode> unary();
-    UnqPtr<ASTNode> term();
-    UnqPtr<ASTNode> termPrime(UnqPtr<ASTNode> left);
-    bool equalOrDifferent();
-    UnqPtr<ASTNode> eqExpr();
-    UnqPtr<ASTNode> eqExprPrime(UnqPtr<ASTNode> left);
-    bool greaterOrLess();
-    UnqPtr<ASTNode> relExpr();
-    UnqPtr<ASTNode> relExprPrime(UnqPtr<ASTNode> left);
-    bool sumOrRest();
-    UnqPtr<ASTNode> expr();
-    UnqPtr<ASTNode> exprPrime(UnqPtr<ASTNode> left);
-    UnqPtr<ASTNode> factor();
+    ProgramNode* program();
+    void topLevelDeclaration(ProgramNode& programNode);
+    ASTNode* topLevelDeclaration(SourceRange& extent);
+    ExprListNode* exprList();
+    bool exprListPrime(ExprListNode*& exprListNode);
+    ASTNode* expression();
+    static Precedence binaryPrecedenceOf(TokenType type);
+    ASTNode* binaryExpr(Precedence minimum);
+    ASTNode* unary();
+    ASTNode* factor();
     bool literal();
-    UnqPtr<ASTNode> Parenthesis(UnqPtr<IdentifierNode> identifier);
-    UnqPtr<ASTNode> factorPrime(UnqPtr<ASTNode> node);
-    UnqPtr<ASTNode> statement();
-    UnqPtr<ASTNode> ifStmt();
-    UnqPtr<ASTNode> ifStmtPrime();
-    UnqPtr<ASTNode> forStmt();
-    UnqPtr<ASTNode> returnStmt();
-    UnqPtr<ASTNode> printStmt();
-    UnqPtr<ASTNode> exprStmt();
-    UnqPtr<ASTNode> stmtList();
-    bool stmtListPrime(UnqPtr<CompoundStatementNode>& compoundNode);
+    ASTNode* Parenthesis(IdentifierNode* identifier);
+    ASTNode* factorPrime(ASTNode* node);
+    ASTNode* statement();
+    ASTNode* ifStmt();
+    ASTNode* ifStmtPrime();
+    ASTNode* forStmt();
+    bool forHeader(ASTNode*& init, ASTNode*& condition, ASTNode*& increment);
+    ASTNode* returnStmt();
+    ASTNode* printStmt();
+    ASTNode* exprStmt();
+    ASTNode* stmtList();
+    void stmtListPrime(CompoundStatementNode& compoundNode);
     bool type();
     bool typePrime();
-    UnqPtr<ASTNode> declaration();
-    UnqPtr<ASTNode> declarationPrime(const Token& typeToken, const Token& identifierToken);
-    UnqPtr<FunctionDeclarationNode> function(const Token& typeToken, const Token& identifierToken);
-    bool params(std::vector<UnqPtr<ParamNode>>& parameters);
-    UnqPtr<VarDeclarationNode> varDecl(const Token& typeToken, const Token& identifierToken);
+    ASTNode* declaration();
+    ASTNode* declarationPrime(const Token& typeToken, const Token& identifierToken);
+    FunctionDeclarationNode* function(const Token& typeToken, const Token& identifierToken);
+    bool params(std::vector<ParamNode*>& parameters);
+    static ASTNode* deferredBody(ASTContext& context, const TokenBuffer& tokens, size_t begin, size_t end);
+    VarDeclarationNode* varDecl(const Token& typeToken, const Token& identifierToken);
     bool varDeclPrime();
-    bool checkForDeclarationStart();
 };
 
 #endif
@@ -1,10 +1,91 @@
 #include "scanner.h"
 #include "token.h"
-#include <cctype>
+#include "simd.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <thread>
+
+namespace {
+
+// Two-character operators are a one-step DFA: the first byte selects the
+// single-character token and the only byte that extends it.
+struct OperatorTransition {
+    TokenType single = TokenType::ERROR;
+    char follow = '\0';
+    TokenType pair = TokenType::ERROR;
+};
+
+constexpr std::array<OperatorTransition, 256> buildOperatorTransitions() {
+    std::array<OperatorTransition, 256> table{};
+    auto set = [&table](char c, TokenType single, char follow = '\0', TokenType pair = TokenType::ERROR) {
+        table[static_cast<unsigned char>(c)] = OperatorTransition{single, follow, pair};
+    };
+    set('+', TokenType::OPERATOR_PLUS);
+    set('-', TokenType::OPERATOR_MINUS);
+    set('*', TokenType::OPERATOR_MULTIPLY);
+    set('/', TokenType::OPERATOR_DIVIDE);
+    set('%', TokenType::OPERATOR_MOD);
+    set('=', TokenType::OPERATOR_ASSIGN, '=', TokenType::OPERATOR_EQUAL);
+    set('!', TokenType::OPERATOR_NOT, '=', TokenType::OPERATOR_NOT_EQUAL);
+    set('<', TokenType::OPERATOR_LESS_THAN, '=', TokenType::OPERATOR_LESS_EQUAL);
+    set('>', TokenType::OPERATOR_GREATER_THAN, '=', TokenType::OPERATOR_GREATER_EQUAL);
+    set('&', TokenType::ERROR, '&', TokenType::OPERATOR_AND);
+    set('|', TokenType::ERROR, '|', TokenType::OPERATOR_OR);
+    set(';', TokenType::SEMICOLON);
+    set(':', TokenType::COLON);
+    set(',', TokenType::COMMA);
+    set('{', TokenType::LEFT_BRACE);
+    set('}', TokenType::RIGHT_BRACE);
+    set('[', TokenType::LEFT_BRACKET);
+    set(']', TokenType::RIGHT_BRACKET);
+    set('(', TokenType::LEFT_PARENTHESIS);
+    set(')', TokenType::RIGHT_PARENTHESIS);
+    return table;
+}
+
+constexpr auto operatorTransitions = buildOperatorTransitions();
+
+enum class CharClass : uint8_t {
+    Other,
+    Whitespace,
+    IdentifierStart,
+    Digit,
+    DoubleQuote,
+    SingleQuote,
+    Punctuator,
+};
+
+constexpr std::array<CharClass, 256> buildCharClasses() {
+    std::array<CharClass, 256> table{};
+    for (int c = 0; c < 256; c++) {
+        const OperatorTransition& op = operatorTransitions[c];
+        if (c == ' ' || (c >= '\t' && c <= '\r')) table[c] = CharClass::Whitespace;
+        else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') table[c] = CharClass::IdentifierStart;
+        else if (c >= '0' && c <= '9') table[c] = CharClass::Digit;
+        else if (c == '"') table[c] = CharClass::DoubleQuote;
+        else if (c == '\'') table[c] = CharClass::SingleQuote;
+        else if (op.single != TokenType::ERROR || op.follow != '\0') table[c] = CharClass::Punctuator;
+        else table[c] = CharClass::Other;
+    }
+    return table;
+}
+
+constexpr auto charClasses = buildCharClasses();
+
+inline CharClass classOf(char c) {
+    return charClasses[static_cast<unsigned char>(c)];
+}
+
+static_assert(charClasses['<'] == CharClass::Punctuator && operatorTransitions['<'].follow == '=');
+static_assert(charClasses['&'] == CharClass::Punctuator && charClasses['#'] == CharClass::Other);
+
+}
 
-Scanner::Scanner(const std::string& source) : source(source), pos(0), line(1), column(1) {}
+Scanner::Scanner(SourceFile& file) : file(file), source(file.getText()), pos(0), tokens(file) {}
 
-const std::vector<Token>& Scanner::getTokens() const {
+const TokenBuffer& Scanner::getTokens() const {
     return tokens;
 }
 
@@ -12,16 +93,14 @@ Token Scanner::getToken() {
     skipWhitespaceAndComments();
     if (isAtEOF()) return createEOFToken();
 
-    char currentChar = peekChar();
-
-    if (isAlpha(currentChar)) return identifierOrKeyword();
-    if (isDigit(currentChar)) return number();
-    if (isQuotationMark(currentChar)) return string();
-    if (isSingleQuote(currentChar)) return character();
-    if (isOperatorStart(currentChar)) return extractOperator();
-    if (isDelimiter(currentChar)) return extractDelimiter();
-
-    return handleSingleCharacterTokens(currentChar);
+    switch (classOf(peekChar())) {
+        case CharClass::IdentifierStart: return identifierOrKeyword();
+        case CharClass::Digit: return number();
+        case CharClass::DoubleQuote: return string();
+        case CharClass::SingleQuote: return character();
+        case CharClass::Punctuator: return extractOperator();
+        default: return unexpectedCharacter();
+    }
 }
 
 void Scanner::scan() {
@@ -33,64 +112,183 @@ void Scanner::scan() {
     tokens.push_back(token);
 }
 
-// Métodos auxiliares pequeños marcados como inline
-inline char Scanner::peekChar() const {
-    return source[pos];
-}
+void Scanner::scanParallel(unsigned threadCount) {
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunkCount = std::min<size_t>(threadCount, source.size() / MIN_PARALLEL_CHUNK);
+    if (pos != 0 || chunkCount < 2) {
+        scan();
+        return;
+    }
 
-inline char Scanner::getChar() {
-    pos++;
-    column++;
-    return source[pos - 1];
+    // Chunks start right after a '\n'. Strings and comments never cross a
+    // newline, so each chunk can be lexed on the assumption that it starts
+    // between tokens.
+    std::vector<Chunk> chunks;
+    size_t begin = 0;
+    for (size_t i = 1; i <= chunkCount && begin < source.size(); i++) {
+        size_t end = source.size();
+        if (i < chunkCount) {
+            end = file.nextLineStart(std::max(begin, source.size() / chunkCount * i));
+        }
+        chunks.push_back(Chunk{begin, end, {}, 0});
+        begin = end;
+    }
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < chunks.size(); i++) {
+        workers.emplace_back([this, &chunks, i] {
+            lexChunk(chunks[i], chunks[i].begin);
+        });
+    }
+    lexChunk(chunks[0], 0);
+    for (std::thread& worker : workers) worker.join();
+
+    // Stitch the chunks together in order. The assumption above only fails
+    // when the previous chunk's last token ran past the boundary (a char
+    // literal holding a raw newline); that chunk is lexed again from where
+    // the token really ended.
+    size_t tokenCount = 0;
+    for (const Chunk& chunk : chunks) tokenCount += chunk.tokens.size();
+    tokens.reserve(tokenCount + 1);
+
+    for (size_t i = 0; i < chunks.size(); i++) {
+        if (i > 0 && chunks[i - 1].resume > chunks[i].begin) {
+            lexChunk(chunks[i], chunks[i - 1].resume);
+        }
+        for (const Token& token : chunks[i].tokens) {
+            tokens.push_back(token);
+        }
+    }
+    pos = chunks.back().resume;
 }
 
-inline bool Scanner::isAtEOF() const {
-    return pos >= source.length();
+// Lexes the tokens that start in [from, chunk.end) with a scanner of its
+// own. The last chunk also produces the END_OF_FILE token.
+void Scanner::lexChunk(Chunk& chunk, size_t from) const {
+    Scanner worker(file);
+    worker.pos = from;
+
+    chunk.tokens.clear();
+    chunk.resume = from;
+
+    bool last = chunk.end == source.size();
+    while (true) {
+        worker.skipWhitespaceAndComments();
+        if (!last && worker.pos >= chunk.end) break;
+        chunk.tokens.push_back(worker.getToken());
+        chunk.resume = worker.pos;
+        if (chunk.tokens.back().type == TokenType::END_OF_FILE) break;
+    }
 }
 
-inline bool Scanner::isAlpha(char c) const {
-    return std::isalpha(c) || c == '_';
+// A token's extent only depends on the bytes up to its end (the one byte of
+// lookahead sits at its end offset), and the scanner carries no state
+// between tokens other than its position. So a token that ends before an
+// edit is unaffected, and once a new token starts where an old one started
+// past the edit, everything after it matches the old stream.
+// Binary search: token ends never decrease.
+static size_t firstTokenEndingAt(const TokenBuffer& tokens, size_t from, size_t offset) {
+    size_t low = from;
+    size_t high = tokens.size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (tokens.end(middle) < offset) low = middle + 1;
+        else high = middle;
+    }
+    return low;
 }
 
-inline bool Scanner::isQuotationMark(char c) const {
-    return c == DOUBLE_QUOTE;
+void Scanner::relex(const TokenBuffer& previous, const std::vector<SourceEdit>& edits) {
+    auto sizeChange = [](const SourceEdit& edit) {
+        return static_cast<int64_t>(edit.inserted.size()) - static_cast<int64_t>(edit.removed);
+    };
+
+    tokens.clear();
+    pos = 0;
+
+    size_t oldIndex = 0; // first old token not yet reused or discarded
+    int64_t delta = 0;   // new offset - old offset past the edits handled so far
+    size_t next = 0;     // next edit to handle
+
+    while (next < edits.size()) {
+        // Old tokens that end before the edit are reused as they are.
+        size_t damaged = firstTokenEndingAt(previous, oldIndex, edits[next].offset);
+        if (damaged > oldIndex) {
+            tokens.appendShifted(previous, oldIndex, damaged, delta, file);
+            pos = static_cast<size_t>(previous.end(damaged - 1) + delta);
+        }
+        oldIndex = damaged;
+
+        delta += sizeChange(edits[next]);
+        int64_t editEnd = static_cast<int64_t>(edits[next].offset + edits[next].removed);
+        next++;
+
+        while (true) {
+            Token token = getToken();
+            int64_t oldStart = static_cast<int64_t>(token.offset) - delta;
+
+            // Once the new tokens reach the next edit it joins this region.
+            while (next < edits.size() && oldStart >= static_cast<int64_t>(edits[next].offset)) {
+                delta += sizeChange(edits[next]);
+                editEnd = static_cast<int64_t>(edits[next].offset + edits[next].removed);
+                oldStart = static_cast<int64_t>(token.offset) - delta;
+                next++;
+            }
+
+            if (oldStart >= editEnd) {
+                while (oldIndex < previous.size() && previous.offset(oldIndex) < oldStart) oldIndex++;
+                if (oldIndex < previous.size() && previous.offset(oldIndex) == oldStart &&
+                    previous.kind(oldIndex) == token.type) {
+                    pos = token.offset; // back in step with the old stream
+                    break;
+                }
+            }
+
+            tokens.push_back(token);
+            if (token.type == TokenType::END_OF_FILE) return;
+        }
+    }
+
+    tokens.appendShifted(previous, oldIndex, previous.size(), delta, file);
+    pos = source.size();
 }
 
-inline bool Scanner::isSingleQuote(char c) const {
-    return c == SINGLE_QUOTE;
+// Métodos auxiliares pequeños marcados como inline
+inline char Scanner::peekChar() const {
+    return pos < source.size() ? source[pos] : '\0';
 }
 
-inline bool Scanner::isDigit(char c) const {
-    return std::isdigit(c);
+// Never moves past the end, so every offset stays inside the file.
+inline char Scanner::getChar() {
+    char currentChar = peekChar();
+    if (pos < source.size()) pos++;
+    return currentChar;
 }
 
-inline bool Scanner::isAlnum(char c) const {
-    return isAlpha(c) || isDigit(c);
+// Lines and columns are not tracked while scanning; tokens keep their
+// offset and the SourceFile maps it back when a message needs it.
+inline Token Scanner::makeToken(TokenType type, size_t start, std::string_view value, NameId name, uint64_t literal) const {
+    return Token(type, value, &file, static_cast<uint32_t>(start), static_cast<uint32_t>(pos - start), name, literal);
 }
 
-inline bool Scanner::isWhitespace(char c) const {
-    return std::isspace(c);
+inline bool Scanner::isAtEOF() const {
+    return pos >= source.length();
 }
 
-inline bool Scanner::isOperatorStart(char c) const {
-    return c == '+' || c == '-' || c == '*' || c == '/' || c == '<' || c == '>' || c == '=' || c == '!' || c == '%' || c == '|' || c == '&';
+inline bool Scanner::isDigit(char c) const {
+    return classOf(c) == CharClass::Digit;
 }
 
-inline bool Scanner::isDelimiter(char c) const {
-    return c == LEFT_BRACE || c == RIGHT_BRACE || c == LEFT_BRACKET || c == RIGHT_BRACKET ||
-           c == LEFT_PARENTHESIS || c == RIGHT_PARENTHESIS;
+inline bool Scanner::isWhitespace(char c) const {
+    return classOf(c) == CharClass::Whitespace;
 }
 
 void Scanner::skipWhitespaceAndComments() {
     while (!isAtEOF()) {
         char currentChar = peekChar();
         if (isWhitespace(currentChar)) {
-            if (currentChar == '\n') {
-                line++;
-                column = 1;
-            }
-            getChar();
-        } else if (currentChar == '/' && source[pos + 1] == '/') {
+            pos = Simd::skipWhitespace(source.data(), pos, source.size());
+        } else if (currentChar == '/' && pos + 1 < source.size() && source[pos + 1] == '/') {
             skipComment();
         }
         else {
@@ -100,67 +298,82 @@ void Scanner::skipWhitespaceAndComments() {
 }
 
 void Scanner::skipComment() {
-    while (!isAtEOF() && peekChar() != '\n') {
-        getChar();
-    }
+    pos = Simd::findLineEnd(source.data(), pos, source.size());
 }
 
 Token Scanner::identifierOrKeyword() {
-    int startColumn = column;
     size_t start = pos;
 
-    while (!isAtEOF() && isAlnum(peekChar())) {
-        getChar();
-    }
-
-    std::string lexeme(source.substr(start, pos - start));
+    pos = Simd::skipIdentifier(source.data(), pos + 1, source.size());
 
-    auto it = tokensMap.find(lexeme);
-    if (it != tokensMap.end()) {
-        return Token(it->second, lexeme, line, startColumn);
-    }
+    std::string_view lexeme = source.substr(start, pos - start);
 
-    return Token(TokenType::IDENTIFIER, lexeme, line, startColumn);
+    TokenType type = lookupKeyword(lexeme);
+    NameId name = type == TokenType::IDENTIFIER ? StringInterner::getInstance().intern(lexeme) : keywordNameId(type);
+    return makeToken(type, start, lexeme, name, type == TokenType::KEYWORD_TRUE);
 }
 
 Token Scanner::number() {
-    int startColumn = column;
     size_t start = pos;
 
+    // Integers are 64-bit signed, so a literal may be at most INT64_MAX. The
+    // digits are still consumed after an overflow so the token ends where
+    // the literal does.
+    constexpr uint64_t limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+    uint64_t value = 0;
+    bool overflow = false;
     while (!isAtEOF() && isDigit(peekChar())) {
-        getChar();
+        uint64_t digit = static_cast<uint64_t>(getChar() - '0');
+        if (value > (limit - digit) / 10) {
+            overflow = true;
+        } else {
+            value = value * 10 + digit;
+        }
     }
 
-    std::string lexeme(source.substr(start, pos - start));
-    return Token(TokenType::LITERAL_INT, lexeme, line, startColumn);
+    if (overflow) {
+        return makeToken(TokenType::ERROR, start, "Integer literal out of range");
+    }
+    return makeToken(TokenType::LITERAL_INT, start, source.substr(start, pos - start), INVALID_NAME, value);
 }
 
 Token Scanner::string() {
-    int startColumn = column;
-    std::string lexeme;
-
+    size_t tokenStart = pos;
     getChar(); // Consume the initial quote
 
-    while (!isAtEOF() && peekChar() != DOUBLE_QUOTE) {
-        char currentChar = getChar();
+    // Literals without escapes are returned as a view of the source; only
+    // the ones that need decoding are copied into the file's side arena.
+    size_t start = pos;
+    std::string decoded;
+    bool hasEscapes = false;
 
-        if (currentChar == '\n') {
-            return Token(TokenType::ERROR, "Unterminated string", line, startColumn);
+    while (true) {
+        size_t stop = Simd::findStringStop(source.data(), pos, source.size());
+        if (hasEscapes) {
+            decoded.append(source.substr(pos, stop - pos));
         }
+        pos = stop;
 
-        if (currentChar == '\\') {
-            lexeme += handleEscapeSequence();
-        } else {
-            lexeme += currentChar;
+        char currentChar = peekChar();
+        if (isAtEOF() || currentChar == '\n') {
+            // The newline is not part of the token.
+            return makeToken(TokenType::ERROR, tokenStart, "Unterminated string");
+        }
+        if (currentChar == DOUBLE_QUOTE) {
+            break;
         }
-    }
 
-    if (isAtEOF()) {
-        return Token(TokenType::ERROR, "Unterminated string", line, startColumn);
+        getChar(); // Consume the backslash
+        if (!hasEscapes) {
+            decoded.assign(source.substr(start, pos - 1 - start));
+            hasEscapes = true;
+        }
+        decoded += handleEscapeSequence();
     }
 
+    std::string_view lexeme = hasEscapes ? file.storeDecoded(decoded) : source.substr(start, pos - start);
     getChar(); // Consume the closing quote
-    return Token(TokenType::LITERAL_STRING, lexeme, line, startColumn);
+    return makeToken(TokenType::LITERAL_STRING, tokenStart, lexeme);
 }
 
 char Scanner::handleEscapeSequence() {
@@ -174,68 +387,45 @@ char Scanner::handleEscapeSequence() {
 }
 
 Token Scanner::character() {
-    int startColumn = column;
+    size_t tokenStart = pos;
     getChar(); // Consume the initial single quote
-    char charValue;
+    std::string_view lexeme;
 
     if (peekChar() == '\\') {
         getChar();
-        charValue = handleEscapeSequence();
+        char charValue = handleEscapeSequence();
+        lexeme = file.storeDecoded(std::string_view(&charValue, 1));
     } else {
-        charValue = getChar();
+        lexeme = source.substr(pos, 1);
+        getChar();
     }
 
-    if (peekChar() != SINGLE_QUOTE) {
-        return Token(TokenType::ERROR, "Unterminated character literal", line, startColumn);
+    if (isAtEOF() || peekChar() != SINGLE_QUOTE) {
+        return makeToken(TokenType::ERROR, tokenStart, "Unterminated character literal");
     }
     getChar(); // Consume the closing single quote
     
-    return Token(TokenType::LITERAL_CHAR, std::string(1, charValue), line, startColumn);
+    return makeToken(TokenType::LITERAL_CHAR, tokenStart, lexeme, INVALID_NAME, static_cast<unsigned char>(lexeme[0]));
 }
 
 Token Scanner::extractOperator() {
-    int startColumn = column;
-    char firstChar = getChar();
-    std::string lexeme(1, firstChar);
-    if (!isAtEOF() && (firstChar == '=' || firstChar == '<' || firstChar == '>' || firstChar == '!') && peekChar() == '=') {
-        lexeme += getChar();
-    } else if (!isAtEOF() && firstChar == '|' && peekChar() == '|') {
-        lexeme += getChar();
-    } else if (!isAtEOF() && firstChar == '&' && peekChar() == '&') {
-        lexeme += getChar();
-    }
-
-    auto it = tokensMap.find(lexeme);
-    if (it != tokensMap.end()) {
-        return Token(it->second, lexeme, line, startColumn);
-    }
-
-    return Token(TokenType::ERROR, lexeme, line, startColumn);
-}
+    size_t start = pos;
+    const OperatorTransition& state = operatorTransitions[static_cast<unsigned char>(getChar())];
 
-Token Scanner::extractDelimiter() {
-    char currentChar = getChar();
-    switch (currentChar) {
-        case LEFT_BRACE: return Token(TokenType::LEFT_BRACE, "{", line, column - 1);
-        case RIGHT_BRACE: return Token(TokenType::RIGHT_BRACE, "}", line, column - 1);
-        case LEFT_BRACKET: return Token(TokenType::LEFT_BRACKET, "[", line, column - 1);
-        case RIGHT_BRACKET: return Token(TokenType::RIGHT_BRACKET, "]", line, column - 1);
-        case LEFT_PARENTHESIS: return Token(TokenType::LEFT_PARENTHESIS, "(", line, column - 1);
-        case RIGHT_PARENTHESIS: return Token(TokenType::RIGHT_PARENTHESIS, ")", line, column - 1);
-        default:  return Token(TokenType::ERROR, std::string(1, currentChar), line, column - 1);
+    TokenType type = state.single;
+    if (state.follow != '\0' && peekChar() == state.follow) {
+        getChar();
+        type = state.pair;
     }
+    return makeToken(type, start, source.substr(start, pos - start));
 }
 
-Token Scanner::handleSingleCharacterTokens(char currentChar) {
-    switch (currentChar) {
-        case COLON: return Token(TokenType::COLON, std::string(1, getChar()), line, column - 1);
-        case SEMICOLON: return Token(TokenType::SEMICOLON, std::string(1, getChar()), line, column - 1);
-        case COMMA: return Token(TokenType::COMMA, std::string(1, getChar()), line, column - 1);
-        case EQUAL_SIGN: return Token(TokenType::OPERATOR_EQUAL, std::string(1, getChar()), line, column - 1);
-        default: return Token(TokenType::ERROR, std::string(1, getChar()), line, column++);
-    }
+Token Scanner::unexpectedCharacter() {
+    size_t start = pos;
+    getChar();
+    return makeToken(TokenType::ERROR, start, source.substr(start, 1));
 }
 
 Token Scanner::createEOFToken() const {
-    return Token(TokenType::END_OF_FILE, "", line, column);
+    return makeToken(TokenType::END_OF_FILE, pos, "");
 }
@@ -1,61 +1,67 @@
 #ifndef SCANNER_H
 #define SCANNER_H
 
+#include <string_view>
 #include <vector>
+#include "source.h"
 #include "token.h"
+#include "tokenbuffer.h"
 
 class Scanner {
     public:
-        Scanner(const std::string& source);
+        Scanner(SourceFile& file);
         ~Scanner() = default;
-        const std::vector<Token>& getTokens() const;
+        const TokenBuffer& getTokens() const;
         Token getToken();
         void scan();
+        // Lexes newline-aligned chunks of the file on separate threads.
+        // Produces exactly the same tokens as scan(); small files are
+        // scanned sequentially. threadCount 0 uses every hardware thread.
+        void scanParallel(unsigned threadCount = 0);
+        // Re-lexes this scanner's file, which is `previous`'s file with
+        // `edits` applied (see SourceManager::applyEdits). Only the tokens
+        // around each edit are scanned again; the rest are copied with their
+        // offsets shifted. Produces exactly the same tokens as scan().
+        void relex(const TokenBuffer& previous, const std::vector<SourceEdit>& edits);
 
         void Consume(const TokenType tokenType);
 
     private:
-        std::string source;
+        SourceFile& file;
+        std::string_view source;
         size_t pos;
-        int line;
-        int column;
-        std::vector<Token> tokens;
+        TokenBuffer tokens;
+
+        // Below this many bytes per chunk, threads cost more than they save.
+        static constexpr size_t MIN_PARALLEL_CHUNK = 256 * 1024;
+
+        struct Chunk {
+            size_t begin;
+            size_t end;
+            std::vector<Token> tokens;   // tokens that start in [begin, end)
+            size_t resume = 0;           // where the last token ended
+        };
 
         static constexpr char DOUBLE_QUOTE = '\"';
         static constexpr char SINGLE_QUOTE = '\'';
-        static constexpr char LEFT_BRACE = '{';
-        static constexpr char RIGHT_BRACE = '}';
-        static constexpr char LEFT_BRACKET = '[';
-        static constexpr char RIGHT_BRACKET = ']';
-        static constexpr char LEFT_PARENTHESIS = '(';
-        static constexpr char RIGHT_PARENTHESIS = ')';
-        static constexpr char COLON = ':';
-        static constexpr char SEMICOLON = ';';
-        static constexpr char COMMA = ',';
-        static constexpr char EQUAL_SIGN = '=';
 
         inline char peekChar() const;
         inline char getChar();
         inline bool isAtEOF() const;
-        inline bool isAlpha(char c) const;
-        inline bool isQuotationMark(char c) const;
-        inline bool isSingleQuote(char c) const;
         inline bool isDigit(char c) const;
-        inline bool isAlnum(char c) const;
         inline bool isWhitespace(char c) const;
-        inline bool isOperatorStart(char c) const;
-        inline bool isDelimiter(char c) const;
 
         void skipWhitespaceAndComments();
         void skipComment();
+        void lexChunk(Chunk& chunk, size_t from) const;
+        inline Token makeToken(TokenType type, size_t start, std::string_view value, NameId name = INVALID_NAME, uint64_t literal = 0) const;
         Token identifierOrKeyword();
         Token number();
         Token string();
         char handleEscapeSequence();
         Token character();
         Token extractOperator();
-        Token extractDelimiter();
-        Token handleSingleCharacterTokens(char currentChar);
+        Token unexpectedCharacter();
         Token createEOFToken() const;
 };
 
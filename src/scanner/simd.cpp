@@ -0,0 +1,298 @@
+#include "simd.h"
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define BMINOR_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Scalar fallbacks ------------------------------------------------------------
+
+inline bool isWhitespaceByte(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+inline bool isIdentifierByte(unsigned char c) {
+    unsigned char lower = c | 0x20;
+    return (lower >= 'a' && lower <= 'z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+inline bool isStringStopByte(unsigned char c) {
+    return c == '"' || c == '\\' || c == '\n';
+}
+
+size_t skipWhitespaceScalar(const char* data, size_t from, size_t size) {
+    while (from < size && isWhitespaceByte(static_cast<unsigned char>(data[from]))) from++;
+    return from;
+}
+
+size_t skipIdentifierScalar(const char* data, size_t from, size_t size) {
+    while (from < size && isIdentifierByte(static_cast<unsigned char>(data[from]))) from++;
+    return from;
+}
+
+size_t findStringStopScalar(const char* data, size_t from, size_t size) {
+    while (from < size && !isStringStopByte(static_cast<unsigned char>(data[from]))) from++;
+    return from;
+}
+
+// Length of the UTF-8 sequence starting at the non-ASCII byte data[0], or 0 if
+// it is malformed (bad lead byte, missing continuation, overlong form,
+// surrogate or code point above U+10FFFF).
+size_t utf8SequenceLength(const unsigned char* data, size_t available) {
+    unsigned char lead = data[0];
+    size_t length;
+    unsigned char low = 0x80, high = 0xBF; // allowed range of the second byte
+    if (lead >= 0xC2 && lead <= 0xDF) length = 2;
+    else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        if (lead == 0xE0) low = 0xA0;
+        if (lead == 0xED) high = 0x9F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        if (lead == 0xF0) low = 0x90;
+        if (lead == 0xF4) high = 0x8F;
+    } else {
+        return 0;
+    }
+    if (available < length || data[1] < low || data[1] > high) return 0;
+    for (size_t i = 2; i < length; i++) {
+        if ((data[i] & 0xC0) != 0x80) return 0;
+    }
+    return length;
+}
+
+// Indexes and validates from pos until it reaches stop. A sequence that
+// straddles stop is finished, so pos may end up past it. Returns false with
+// pos on the malformed byte.
+bool indexLinesScalar(const char* data, size_t& pos, size_t stop, size_t size, std::vector<uint32_t>& lineStarts) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    while (pos < stop) {
+        unsigned char c = bytes[pos];
+        if (c < 0x80) {
+            if (c == '\n') lineStarts.push_back(static_cast<uint32_t>(pos + 1));
+            pos++;
+            continue;
+        }
+        size_t length = utf8SequenceLength(bytes + pos, size - pos);
+        if (length == 0) return false;
+        pos += length;
+    }
+    return true;
+}
+
+size_t indexLinesScalar(const char* data, size_t size, std::vector<uint32_t>& lineStarts) {
+    size_t pos = 0;
+    indexLinesScalar(data, pos, size, size, lineStarts);
+    return pos;
+}
+
+#ifdef BMINOR_SIMD_X86
+
+// Byte ranges are tested with one signed compare: shifting by 0x80 - lo moves
+// [lo, hi] to the bottom of the signed range.
+inline __m128i inRange128(__m128i v, char lo, char hi) {
+    __m128i shifted = _mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(0x80 - lo)));
+    return _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(0x80 + (hi - lo) + 1)));
+}
+
+inline __m128i whitespaceMask128(__m128i v) {
+    return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), inRange128(v, '\t', '\r'));
+}
+
+inline __m128i identifierMask128(__m128i v) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i alpha = inRange128(lower, 'a', 'z');
+    __m128i digit = inRange128(v, '0', '9');
+    __m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+    return _mm_or_si128(_mm_or_si128(alpha, digit), underscore);
+}
+
+inline __m128i stringStopMask128(__m128i v) {
+    __m128i quote = _mm_cmpeq_epi8(v, _mm_set1_epi8('"'));
+    __m128i backslash = _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'));
+    __m128i newline = _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'));
+    return _mm_or_si128(_mm_or_si128(quote, backslash), newline);
+}
+
+// StopInside selects whether the run ends on the first byte inside the class
+// (search) or on the first byte outside it (skip).
+template <__m128i (*Mask)(__m128i), bool StopInside>
+size_t scan128(const char* data, size_t from, size_t size) {
+    while (from + 16 <= size) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + from));
+        unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(Mask(chunk)));
+        if (!StopInside) bits = ~bits & 0xFFFFu;
+        if (bits) return from + static_cast<size_t>(__builtin_ctz(bits));
+        from += 16;
+    }
+    return from;
+}
+
+size_t skipWhitespaceSse2(const char* data, size_t from, size_t size) {
+    return skipWhitespaceScalar(data, scan128<whitespaceMask128, false>(data, from, size), size);
+}
+
+size_t skipIdentifierSse2(const char* data, size_t from, size_t size) {
+    return skipIdentifierScalar(data, scan128<identifierMask128, false>(data, from, size), size);
+}
+
+size_t findStringStopSse2(const char* data, size_t from, size_t size) {
+    return findStringStopScalar(data, scan128<stringStopMask128, true>(data, from, size), size);
+}
+
+// ASCII blocks are handled with two masks: the newlines give the line starts
+// and the sign bits tell whether any byte needs UTF-8 checking. From the
+// first non-ASCII byte on, the rest of the block goes through the scalar
+// validator.
+size_t indexLinesSse2(const char* data, size_t size, std::vector<uint32_t>& lineStarts) {
+    size_t pos = 0;
+    while (pos + 16 <= size) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        unsigned newlines = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'))));
+        unsigned nonAscii = static_cast<unsigned>(_mm_movemask_epi8(chunk));
+        size_t asciiRun = nonAscii ? static_cast<size_t>(__builtin_ctz(nonAscii)) : 16;
+        if (nonAscii) newlines &= (1u << asciiRun) - 1;
+        for (; newlines; newlines &= newlines - 1) {
+            lineStarts.push_back(static_cast<uint32_t>(pos + __builtin_ctz(newlines) + 1));
+        }
+        size_t blockEnd = pos + 16;
+        pos += asciiRun;
+        if (nonAscii && !indexLinesScalar(data, pos, blockEnd, size, lineStarts)) return pos;
+    }
+    indexLinesScalar(data, pos, size, size, lineStarts);
+    return pos;
+}
+
+#define BMINOR_AVX2 __attribute__((target("avx2")))
+
+BMINOR_AVX2 inline __m256i inRange256(__m256i v, char lo, char hi) {
+    __m256i shifted = _mm256_add_epi8(v, _mm256_set1_epi8(static_cast<char>(0x80 - lo)));
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(0x80 + (hi - lo) + 1)), shifted);
+}
+
+BMINOR_AVX2 inline __m256i whitespaceMask256(__m256i v) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), inRange256(v, '\t', '\r'));
+}
+
+BMINOR_AVX2 inline __m256i identifierMask256(__m256i v) {
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i alpha = inRange256(lower, 'a', 'z');
+    __m256i digit = inRange256(v, '0', '9');
+    __m256i underscore = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+    return _mm256_or_si256(_mm256_or_si256(alpha, digit), underscore);
+}
+
+BMINOR_AVX2 inline __m256i stringStopMask256(__m256i v) {
+    __m256i quote = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'));
+    __m256i backslash = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'));
+    __m256i newline = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'));
+    return _mm256_or_si256(_mm256_or_si256(quote, backslash), newline);
+}
+
+// The tail shorter than one block goes to the scalar loop. Staying away from
+// the SSE2 versions here avoids AVX/SSE transition stalls.
+template <__m256i (*Mask)(__m256i), bool StopInside>
+BMINOR_AVX2 size_t scan256(const char* data, size_t from, size_t size) {
+    while (from + 32 <= size) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + from));
+        unsigned bits = static_cast<unsigned>(_mm256_movemask_epi8(Mask(chunk)));
+        if (!StopInside) bits = ~bits;
+        if (bits) return from + static_cast<size_t>(__builtin_ctz(bits));
+        from += 32;
+    }
+    return from;
+}
+
+BMINOR_AVX2 size_t skipWhitespaceAvx2(const char* data, size_t from, size_t size) {
+    return skipWhitespaceScalar(data, scan256<whitespaceMask256, false>(data, from, size), size);
+}
+
+BMINOR_AVX2 size_t skipIdentifierAvx2(const char* data, size_t from, size_t size) {
+    return skipIdentifierScalar(data, scan256<identifierMask256, false>(data, from, size), size);
+}
+
+BMINOR_AVX2 size_t findStringStopAvx2(const char* data, size_t from, size_t size) {
+    return findStringStopScalar(data, scan256<stringStopMask256, true>(data, from, size), size);
+}
+
+BMINOR_AVX2 size_t indexLinesAvx2(const char* data, size_t size, std::vector<uint32_t>& lineStarts) {
+    size_t pos = 0;
+    while (pos + 32 <= size) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        unsigned newlines = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n'))));
+        unsigned nonAscii = static_cast<unsigned>(_mm256_movemask_epi8(chunk));
+        size_t asciiRun = nonAscii ? static_cast<size_t>(__builtin_ctz(nonAscii)) : 32;
+        if (nonAscii) newlines &= (1u << asciiRun) - 1;
+        for (; newlines; newlines &= newlines - 1) {
+            lineStarts.push_back(static_cast<uint32_t>(pos + __builtin_ctz(newlines) + 1));
+        }
+        size_t blockEnd = pos + 32;
+        pos += asciiRun;
+        if (nonAscii && !indexLinesScalar(data, pos, blockEnd, size, lineStarts)) return pos;
+    }
+    indexLinesScalar(data, pos, size, size, lineStarts);
+    return pos;
+}
+
+#endif
+
+struct Kernels {
+    size_t (*skipWhitespace)(const char*, size_t, size_t);
+    size_t (*skipIdentifier)(const char*, size_t, size_t);
+    size_t (*findStringStop)(const char*, size_t, size_t);
+    size_t (*indexLines)(const char*, size_t, std::vector<uint32_t>&);
+    const char* name;
+};
+
+Kernels selectKernels() {
+#ifdef BMINOR_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {skipWhitespaceAvx2, skipIdentifierAvx2, findStringStopAvx2, indexLinesAvx2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {skipWhitespaceSse2, skipIdentifierSse2, findStringStopSse2, indexLinesSse2, "sse2"};
+    }
+#endif
+    return {skipWhitespaceScalar, skipIdentifierScalar, findStringStopScalar, indexLinesScalar, "scalar"};
+}
+
+const Kernels& kernels() {
+    static const Kernels selected = selectKernels();
+    return selected;
+}
+
+}
+
+namespace Simd {
+
+size_t skipWhitespace(const char* data, size_t from, size_t size) {
+    return kernels().skipWhitespace(data, from, size);
+}
+
+size_t skipIdentifier(const char* data, size_t from, size_t size) {
+    return kernels().skipIdentifier(data, from, size);
+}
+
+size_t findLineEnd(const char* data, size_t from, size_t size) {
+    if (from >= size) return size;
+    const void* found = std::memchr(data + from, '\n', size - from);
+    return found ? static_cast<size_t>(static_cast<const char*>(found) - data) : size;
+}
+
+size_t findStringStop(const char* data, size_t from, size_t size) {
+    return kernels().findStringStop(data, from, size);
+}
+
+size_t indexLines(const char* data, size_t size, std::vector<uint32_t>& lineStarts) {
+    return kernels().indexLines(data, size, lineStarts);
+}
+
+const char* implementationName() {
+    return kernels().name;
+}
+
+}
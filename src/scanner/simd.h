@@ -0,0 +1,35 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Vectorized helpers for the scanner's hot loops. Every function takes the
+// whole buffer plus a starting offset and returns the offset of the first
+// byte that stops the run (or `size` if the run reaches the end).
+// The implementation (AVX2, SSE2 or scalar) is picked once at runtime.
+namespace Simd {
+    // Skips ' ', '\t', '\n', '\v', '\f' and '\r'.
+    size_t skipWhitespace(const char* data, size_t from, size_t size);
+
+    // Skips [A-Za-z0-9_].
+    size_t skipIdentifier(const char* data, size_t from, size_t size);
+
+    // Finds the next '\n' (end of a // comment).
+    size_t findLineEnd(const char* data, size_t from, size_t size);
+
+    // Finds the next '"', '\\' or '\n' inside a string literal.
+    size_t findStringStop(const char* data, size_t from, size_t size);
+
+    // Checks that data[0, size) is well-formed UTF-8 and appends the offset of
+    // the byte after every '\n' to lineStarts, in a single pass. Returns the
+    // offset of the first malformed byte, or `size` if there is none (lines
+    // are recorded up to that point).
+    size_t indexLines(const char* data, size_t size, std::vector<uint32_t>& lineStarts);
+
+    // Name of the selected implementation, for diagnostics.
+    const char* implementationName();
+}
+
+#endif
@@ -0,0 +1,112 @@
+#include "source.h"
+#include "simd.h"
+#include "../utils/logger.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BMINOR_HAS_MMAP 1
+#endif
+
+SourceFile::~SourceFile() {
+#ifdef BMINOR_HAS_MMAP
+    if (mapping) {
+        munmap(mapping, mappingSize);
+    }
+#endif
+}
+
+SourcePosition SourceFile::getPosition(size_t offset) const {
+    auto next = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+    size_t line = static_cast<size_t>(next - lineStarts.begin());
+    return SourcePosition{static_cast<int>(line), static_cast<int>(offset - lineStarts[line - 1]) + 1};
+}
+
+size_t SourceFile::nextLineStart(size_t offset) const {
+    auto next = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+    return next == lineStarts.end() ? size : *next;
+}
+
+size_t SourceFile::buildLineStarts() {
+    lineStarts.clear();
+    lineStarts.push_back(0);
+    return Simd::indexLines(data, size, lineStarts);
+}
+
+SourceFile* SourceManager::addFile(std::unique_ptr<SourceFile> file) {
+    size_t invalid = file->buildLineStarts();
+    if (invalid != file->size) {
+        SourcePosition position = file->getPosition(invalid);
+        Logger::getInstance().error("Source file '" + file->name + "' is not valid UTF-8 (line " +
+                                    std::to_string(position.line) + ", column " + std::to_string(position.column) + ")");
+        return nullptr;
+    }
+    files.push_back(std::move(file));
+    return files.back().get();
+}
+
+SourceFile* SourceManager::loadFile(const std::string& path) {
+    std::unique_ptr<SourceFile> file(new SourceFile(path));
+
+#ifdef BMINOR_HAS_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        Logger::getInstance().error("Could not open source file '" + path + "'");
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            // The file is read front to back, first by the line indexer and
+            // then by the scanner; read-ahead keeps the next block ready.
+            madvise(mapped, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+            file->mapping = mapped;
+            file->mappingSize = static_cast<size_t>(info.st_size);
+            file->data = static_cast<const char*>(mapped);
+            file->size = file->mappingSize;
+        }
+    }
+    close(fd);
+    if (file->mapping) {
+        return addFile(std::move(file));
+    }
+#endif
+
+    // Empty files, pipes and platforms without mmap are read into memory.
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        Logger::getInstance().error("Could not open source file '" + path + "'");
+        return nullptr;
+    }
+    file->buffer.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    file->data = file->buffer.data();
+    file->size = file->buffer.size();
+    return addFile(std::move(file));
+}
+
+SourceFile* SourceManager::addBuffer(const std::string& name, std::string contents) {
+    std::unique_ptr<SourceFile> file(new SourceFile(name));
+    file->buffer = std::move(contents);
+    file->data = file->buffer.data();
+    file->size = file->buffer.size();
+    return addFile(std::move(file));
+}
+
+SourceFile* SourceManager::applyEdits(const SourceFile& file, const std::vector<SourceEdit>& edits) {
+    std::string_view text = file.getText();
+    std::string contents;
+    size_t copied = 0;
+    for (const SourceEdit& edit : edits) {
+        contents.append(text.substr(copied, edit.offset - copied));
+        contents.append(edit.inserted);
+        copied = edit.offset + edit.removed;
+    }
+    contents.append(text.substr(copied));
+    return addBuffer(file.getName(), std::move(contents));
+}
@@ -0,0 +1,89 @@
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../utils/arena.h"
+
+// One replacement in a source buffer: `removed` bytes at `offset` (in the
+// unedited text) are replaced by `inserted`.
+struct SourceEdit {
+    size_t offset;
+    size_t removed;
+    std::string inserted;
+};
+
+struct SourcePosition {
+    int line;
+    int column;
+};
+
+// Contents of one input file. The text is mapped read-only and tokens refer to
+// it directly instead of copying their lexemes.
+class SourceFile {
+public:
+    ~SourceFile();
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+
+    const std::string& getName() const { return name; }
+    std::string_view getText() const { return std::string_view(data, size); }
+
+    // 1-based line and column of a byte offset. Tokens only keep offsets and
+    // this looks them up in the newline table built when the file was added.
+    SourcePosition getPosition(size_t offset) const;
+
+    // Start of the first line that begins after `offset`, or the file size.
+    size_t nextLineStart(size_t offset) const;
+
+    // Keeps literals whose value differs from the source text (escape sequences).
+    // Safe to call from the parallel lexer's worker threads.
+    std::string_view storeDecoded(std::string_view decoded) {
+        std::lock_guard<std::mutex> lock(decodedMutex);
+        return decodedArena.copyString(decoded);
+    }
+
+private:
+    friend class SourceManager;
+    SourceFile(const std::string& name) : name(name) {}
+
+    std::string name;
+    const char* data = "";
+    size_t size = 0;
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    std::string buffer; // in-memory sources, or files that could not be mapped
+    BumpArena decodedArena{4096};
+    std::mutex decodedMutex;
+
+    std::vector<uint32_t> lineStarts; // offset of the first byte of each line
+    // Returns the offset of the first malformed UTF-8 byte, or size.
+    size_t buildLineStarts();
+};
+
+class SourceManager {
+public:
+    SourceManager() = default;
+    SourceManager(const SourceManager&) = delete;
+    SourceManager& operator=(const SourceManager&) = delete;
+
+    SourceFile* loadFile(const std::string& path);
+    SourceFile* addBuffer(const std::string& name, std::string contents);
+    // New in-memory version of `file` with the edits applied. Edits must be
+    // sorted by offset and must not overlap.
+    SourceFile* applyEdits(const SourceFile& file, const std::vector<SourceEdit>& edits);
+
+private:
+    std::vector<std::unique_ptr<SourceFile>> files;
+
+    // Indexes the file and takes ownership of it, or rejects it if the text
+    // is not valid UTF-8.
+    SourceFile* addFile(std::unique_ptr<SourceFile> file);
+};
+
+#endif
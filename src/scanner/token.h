@@ -1,9 +1,15 @@
 #ifndef TOKEN_H
 #define TOKEN_H
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 
+#include "../utils/interner.h"
 #include "../utils/logger.h"
+#include "source.h"
 
 enum class TokenType {
     IDENTIFIER,
@@ -68,142 +74,245 @@ enum class TokenType {
     ERROR, // borrar
 };
 
-static std::unordered_map<std::string, TokenType> tokensMap = {
-    // Keywords --------------------------------------------
-    {"array", TokenType::KEYWORD_ARRAY},
-    {"boolean", TokenType::KEYWORD_BOOLEAN},
-    {"char", TokenType::KEYWORD_CHAR},
-    {"else", TokenType::KEYWORD_ELSE},
-    {"false", TokenType::KEYWORD_FALSE},
-    {"for", TokenType::KEYWORD_FOR},
-    {"function", TokenType::KEYWORD_FUNCTION},
-    {"if", TokenType::KEYWORD_IF},
-    {"integer", TokenType::KEYWORD_INTEGER},
-    {"map", TokenType::KEYWORD_MAP},
-    {"print", TokenType::KEYWORD_PRINT},
-    {"return", TokenType::KEYWORD_RETURN},
-    {"string", TokenType::KEYWORD_STRING},
-    {"true", TokenType::KEYWORD_TRUE},
-    {"void", TokenType::KEYWORD_VOID},
-    {"while", TokenType::KEYWORD_WHILE},
-
-    // Operators --------------------------------------------
-    {"+", TokenType::OPERATOR_PLUS},
-    {"-", TokenType::OPERATOR_MINUS},
-    {"*", TokenType::OPERATOR_MULTIPLY},
-    {"/", TokenType::OPERATOR_DIVIDE},
-    {"%", TokenType::OPERATOR_MOD},
-
-    {"==", TokenType::OPERATOR_EQUAL},
-    {"!=", TokenType::OPERATOR_NOT_EQUAL},
-    {"<", TokenType::OPERATOR_LESS_THAN},
-    {">", TokenType::OPERATOR_GREATER_THAN},
-    {"<=", TokenType::OPERATOR_LESS_EQUAL},
-    {">=", TokenType::OPERATOR_GREATER_EQUAL},
-    
-    { "&&", TokenType::OPERATOR_AND},
-    { "||", TokenType::OPERATOR_OR},
-    { "!", TokenType::OPERATOR_NOT},
-
-    { "=", TokenType::OPERATOR_ASSIGN},
-
-    // Varied
-    {";", TokenType::SEMICOLON},
-    {":", TokenType::COLON},
-    {",", TokenType::COMMA},
-
-    {"{", TokenType::LEFT_BRACE},
-    {"}", TokenType::RIGHT_BRACE},
-    {"[", TokenType::LEFT_BRACKET},
-    {"]", TokenType::RIGHT_BRACKET},
-    {"(", TokenType::LEFT_PARENTHESIS},
-    {")", TokenType::RIGHT_PARENTHESIS},
-
-    {"\032", TokenType::END_OF_FILE},
-};
-
-static const std::unordered_map<TokenType, std::string> tokenTypeMap = {
-    {TokenType::IDENTIFIER, "IDENTIFIER"},
-
-    // Literals
-    {TokenType::LITERAL_INT, "INT_LITERAL"},
-    {TokenType::LITERAL_CHAR, "CHAR_LITERAL"},
-    {TokenType::LITERAL_STRING, "STRING_LITERAL"},
-
-    // Keywords
-    {TokenType::KEYWORD_ARRAY, "KEYWORD_ARRAY"},
-    {TokenType::KEYWORD_BOOLEAN, "KEYWORD_BOOLEAN"},
-    {TokenType::KEYWORD_CHAR, "KEYWORD_CHAR"},
-    {TokenType::KEYWORD_ELSE, "KEYWORD_ELSE"},
-    {TokenType::KEYWORD_FALSE, "KEYWORD_FALSE"},
-    {TokenType::KEYWORD_FOR, "KEYWORD_FOR"},
-    {TokenType::KEYWORD_FUNCTION, "KEYWORD_FUNCTION"},
-    {TokenType::KEYWORD_IF, "KEYWORD_IF"},
-    {TokenType::KEYWORD_INTEGER, "KEYWORD_INTEGER"},
-    {TokenType::KEYWORD_MAP, "KEYWORD_MAP"},
-    {TokenType::KEYWORD_PRINT, "KEYWORD_PRINT"},
-    {TokenType::KEYWORD_RETURN, "KEYWORD_RETURN"},
-    {TokenType::KEYWORD_STRING, "KEYWORD_STRING"},
-    {TokenType::KEYWORD_TRUE, "KEYWORD_TRUE"},
-    {TokenType::KEYWORD_VOID, "KEYWORD_VOID"},
-    {TokenType::KEYWORD_WHILE, "KEYWORD_WHILE"},
-
-    // Operators
-    {TokenType::OPERATOR_PLUS, "OPERATOR_PLUS"},
-    {TokenType::OPERATOR_MINUS, "OPERATOR_MINUS"},
-    {TokenType::OPERATOR_MULTIPLY, "OPERATOR_MULTIPLY"},
-    {TokenType::OPERATOR_DIVIDE, "OPERATOR_DIVIDE"},
-    {TokenType::OPERATOR_MOD, "OPERATOR_MOD"},
-
-    {TokenType::OPERATOR_EQUAL, "OPERATOR_EQUAL"},
-    {TokenType::OPERATOR_NOT_EQUAL, "OPERATOR_NOT_EQUAL"},
-    {TokenType::OPERATOR_LESS_THAN, "OPERATOR_LESS_THAN"},
-    {TokenType::OPERATOR_GREATER_THAN, "OPERATOR_GREATER_THAN"},
-    {TokenType::OPERATOR_LESS_EQUAL, "OPERATOR_LESS_EQUAL"},
-    {TokenType::OPERATOR_GREATER_EQUAL, "OPERATOR_GREATER_EQUAL"},
-
-    {TokenType::OPERATOR_AND, "OPERATOR_AND"},
-    {TokenType::OPERATOR_OR, "OPERATOR_OR"},
-    {TokenType::OPERATOR_NOT, "OPERATOR_NOT"},
+// Keyword and operator lookup ------------------------------------------------
+// Both tables are perfect hashes built at compile time: a lexeme is hashed
+// from its first byte, last byte and length, and a single string compare
+// confirms the hit. Nothing is constructed at startup.
+namespace TokenTables {
+    struct Entry {
+        std::string_view text;
+        TokenType type;
+    };
+
+    inline constexpr Entry keywords[] = {
+        {"array", TokenType::KEYWORD_ARRAY},
+        {"boolean", TokenType::KEYWORD_BOOLEAN},
+        {"char", TokenType::KEYWORD_CHAR},
+        {"else", TokenType::KEYWORD_ELSE},
+        {"false", TokenType::KEYWORD_FALSE},
+        {"for", TokenType::KEYWORD_FOR},
+        {"function", TokenType::KEYWORD_FUNCTION},
+        {"if", TokenType::KEYWORD_IF},
+        {"integer", TokenType::KEYWORD_INTEGER},
+        {"map", TokenType::KEYWORD_MAP},
+        {"print", TokenType::KEYWORD_PRINT},
+        {"return", TokenType::KEYWORD_RETURN},
+        {"string", TokenType::KEYWORD_STRING},
+        {"true", TokenType::KEYWORD_TRUE},
+        {"void", TokenType::KEYWORD_VOID},
+        {"while", TokenType::KEYWORD_WHILE},
+    };
+
+    inline constexpr Entry operators[] = {
+        {"+", TokenType::OPERATOR_PLUS},
+        {"-", TokenType::OPERATOR_MINUS},
+        {"*", TokenType::OPERATOR_MULTIPLY},
+        {"/", TokenType::OPERATOR_DIVIDE},
+        {"%", TokenType::OPERATOR_MOD},
+
+        {"==", TokenType::OPERATOR_EQUAL},
+        {"!=", TokenType::OPERATOR_NOT_EQUAL},
+        {"<", TokenType::OPERATOR_LESS_THAN},
+        {">", TokenType::OPERATOR_GREATER_THAN},
+        {"<=", TokenType::OPERATOR_LESS_EQUAL},
+        {">=", TokenType::OPERATOR_GREATER_EQUAL},
+
+        {"&&", TokenType::OPERATOR_AND},
+        {"||", TokenType::OPERATOR_OR},
+        {"!", TokenType::OPERATOR_NOT},
+
+        {"=", TokenType::OPERATOR_ASSIGN},
+
+        {";", TokenType::SEMICOLON},
+        {":", TokenType::COLON},
+        {",", TokenType::COMMA},
+
+        {"{", TokenType::LEFT_BRACE},
+        {"}", TokenType::RIGHT_BRACE},
+        {"[", TokenType::LEFT_BRACKET},
+        {"]", TokenType::RIGHT_BRACKET},
+        {"(", TokenType::LEFT_PARENTHESIS},
+        {")", TokenType::RIGHT_PARENTHESIS},
+    };
+
+    // Slots is a power of two; FirstMul and LastMul were searched offline so
+    // that every entry of the table lands in its own slot.
+    template <size_t Slots, unsigned FirstMul, unsigned LastMul>
+    struct PerfectHash {
+        static constexpr size_t hash(std::string_view text) {
+            return (static_cast<unsigned char>(text.front()) * FirstMul +
+                    static_cast<unsigned char>(text.back()) * LastMul + text.size()) & (Slots - 1);
+        }
 
-    {TokenType::OPERATOR_ASSIGN, "OPERATOR_ASSIGN"},
+        std::array<int8_t, Slots> slots{};
+        bool collisionFree = true;
+
+        template <size_t N>
+        constexpr explicit PerfectHash(const Entry (&entries)[N]) {
+            for (size_t i = 0; i < Slots; i++) slots[i] = -1;
+            for (size_t i = 0; i < N; i++) {
+                size_t slot = hash(entries[i].text);
+                if (slots[slot] != -1) collisionFree = false;
+                slots[slot] = static_cast<int8_t>(i);
+            }
+        }
 
-    // Varied
-    {TokenType::SEMICOLON, "SEMICOLON"},
-    {TokenType::COMMA, "COMMA"},
-    {TokenType::COLON, "COLON"},
-
-    {TokenType::LEFT_BRACE, "LEFT_BRACE"},
-    {TokenType::RIGHT_BRACE, "RIGHT_BRACE"},
-    {TokenType::LEFT_BRACKET, "LEFT_BRACKET"},
-    {TokenType::RIGHT_BRACKET, "RIGHT_BRACKET"},
-    {TokenType::LEFT_PARENTHESIS, "LEFT_PARENTHESIS"},
-    {TokenType::RIGHT_PARENTHESIS, "RIGHT_PARENTHESIS"},
-
-    {TokenType::END_OF_FILE, "END_OF_FILE"},
-    {TokenType::ERROR, "ERROR"},
+        template <size_t N>
+        constexpr TokenType find(const Entry (&entries)[N], std::string_view text, TokenType fallback) const {
+            if (text.empty()) return fallback;
+            int8_t index = slots[hash(text)];
+            if (index < 0 || entries[index].text != text) return fallback;
+            return entries[index].type;
+        }
+    };
+
+    inline constexpr PerfectHash<32, 4, 0> keywordHash(keywords);
+    inline constexpr PerfectHash<128, 2, 3> operatorHash(operators);
+    static_assert(keywordHash.collisionFree, "keyword hash constants need to be searched again");
+    static_assert(operatorHash.collisionFree, "operator hash constants need to be searched again");
+
+    inline constexpr std::string_view typeNames[] = {
+        "IDENTIFIER",
+
+        // Literals
+        "INT_LITERAL",
+        "CHAR_LITERAL",
+        "STRING_LITERAL",
+
+        // Keywords
+        "KEYWORD_ARRAY",
+        "KEYWORD_BOOLEAN",
+        "KEYWORD_CHAR",
+        "KEYWORD_ELSE",
+        "KEYWORD_FALSE",
+        "KEYWORD_FOR",
+        "KEYWORD_FUNCTION",
+        "KEYWORD_IF",
+        "KEYWORD_INTEGER",
+        "KEYWORD_MAP",
+        "KEYWORD_PRINT",
+        "KEYWORD_RETURN",
+        "KEYWORD_STRING",
+        "KEYWORD_TRUE",
+        "KEYWORD_VOID",
+        "KEYWORD_WHILE",
+
+        // Operators
+        "OPERATOR_PLUS",
+        "OPERATOR_MINUS",
+        "OPERATOR_MULTIPLY",
+        "OPERATOR_DIVIDE",
+        "OPERATOR_MOD",
+
+        "OPERATOR_EQUAL",
+        "OPERATOR_NOT_EQUAL",
+        "OPERATOR_LESS_THAN",
+        "OPERATOR_GREATER_THAN",
+        "OPERATOR_LESS_EQUAL",
+        "OPERATOR_GREATER_EQUAL",
+
+        "OPERATOR_AND",
+        "OPERATOR_OR",
+        "OPERATOR_NOT",
+
+        "OPERATOR_ASSIGN",
+
+        // Varied
+        "SEMICOLON",
+        "COMMA",
+        "COLON",
+
+        "LEFT_BRACE",
+        "RIGHT_BRACE",
+        "LEFT_BRACKET",
+        "RIGHT_BRACKET",
+        "LEFT_PARENTHESIS",
+        "RIGHT_PARENTHESIS",
+
+        "END_OF_FILE",
+        "ERROR",
+    };
+    static_assert(std::size(typeNames) == static_cast<size_t>(TokenType::ERROR) + 1,
+                  "typeNames must have one entry per TokenType");
+}
+
+// Returns KEYWORD_* for reserved words and IDENTIFIER for anything else.
+constexpr TokenType lookupKeyword(std::string_view text) {
+    return TokenTables::keywordHash.find(TokenTables::keywords, text, TokenType::IDENTIFIER);
+}
+
+// Returns the operator or punctuation type, or ERROR if text is not one.
+constexpr TokenType lookupOperator(std::string_view text) {
+    return TokenTables::operatorHash.find(TokenTables::operators, text, TokenType::ERROR);
+}
+
+// Keywords are interned at fixed ids: their index in TokenTables::keywords.
+constexpr NameId keywordNameId(TokenType keyword) {
+    return static_cast<NameId>(keyword) - static_cast<NameId>(TokenType::KEYWORD_ARRAY);
+}
+
+constexpr bool keywordIdsMatchTable() {
+    for (size_t i = 0; i < std::size(TokenTables::keywords); i++) {
+        if (keywordNameId(TokenTables::keywords[i].type) != i) return false;
+    }
+    return true;
+}
+static_assert(keywordIdsMatchTable(), "TokenTables::keywords must follow the KEYWORD_* order");
+
+constexpr std::string_view tokenTypeName(TokenType type) {
+    return TokenTables::typeNames[static_cast<size_t>(type)];
+}
+
+static_assert(lookupKeyword("while") == TokenType::KEYWORD_WHILE);
+static_assert(lookupKeyword("whilst") == TokenType::IDENTIFIER);
+static_assert(lookupOperator("<=") == TokenType::OPERATOR_LESS_EQUAL);
+static_assert(lookupOperator("&") == TokenType::ERROR);
+
+// Set of token kinds as a 64-bit mask; membership is a shift and an AND. The
+// parser keeps its FIRST and FOLLOW sets as constexpr TokenSets.
+class TokenSet {
+public:
+    constexpr TokenSet() = default;
+    constexpr TokenSet(std::initializer_list<TokenType> types) {
+        for (TokenType type : types) bits |= bit(type);
+    }
+
+    constexpr bool contains(TokenType type) const { return (bits & bit(type)) != 0; }
+    constexpr TokenSet operator|(TokenSet other) const { return TokenSet(bits | other.bits); }
+
+private:
+    constexpr explicit TokenSet(uint64_t bits) : bits(bits) {}
+    static constexpr uint64_t bit(TokenType type) { return uint64_t(1) << static_cast<unsigned>(type); }
+
+    uint64_t bits = 0;
 };
 
+static_assert(static_cast<unsigned>(TokenType::ERROR) < 64, "TokenSet needs one bit per TokenType");
+static_assert(TokenSet{TokenType::COMMA, TokenType::SEMICOLON}.contains(TokenType::SEMICOLON));
+static_assert(!TokenSet{TokenType::COMMA}.contains(TokenType::SEMICOLON));
+
 class Token {
     public:
         TokenType type;
-        std::string value;
-        int line;
-        int column;
-
-        Token(TokenType type, const std::string& value, int line, int column)
-            : type(type), value(value), line(line), column(column) {}
+        std::string_view value; // view into the SourceFile, never owned
+        NameId name;            // interned identifier or keyword, INVALID_NAME otherwise
+        uint64_t literal;       // decoded value of integer, char and boolean literals
+        uint32_t offset;        // source extent of the token
+        uint32_t length;
+        const SourceFile* file;
+
+        Token(TokenType type, std::string_view value, const SourceFile* file, uint32_t offset, uint32_t length,
+              NameId name = INVALID_NAME, uint64_t literal = 0)
+            : type(type), value(value), name(name), literal(literal), offset(offset), length(length), file(file) {}
         ~Token() = default;
 
+        // Positions are looked up from the offset when a message needs them.
+        int line() const { return file ? file->getPosition(offset).line : 0; }
+        int column() const { return file ? file->getPosition(offset).column : 0; }
+
         void print() const {
-            Logger& logger = Logger::getInstance();
-            
-            std::string tokenTypeName = tokenTypeMap.at(type);
-
-            std::string message = "TOKEN VALUE: '" + value + "' TOKEN TYPE: " + tokenTypeName +
-                                  " (Line " + std::to_string(line) + ", Column " + std::to_string(column) + ")";
-            
-            logger.info(message);
+            LOG_INFO("TOKEN VALUE: '" + std::string(value) + "' TOKEN TYPE: " + std::string(tokenTypeName(type)) +
+                     " (Line " + std::to_string(line()) + ", Column " + std::to_string(column()) + ")");
         }
 };
 
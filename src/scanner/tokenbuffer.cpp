@@ -0,0 +1,88 @@
+#include "tokenbuffer.h"
+
+void TokenBuffer::reserve(size_t count) {
+    kinds.reserve(count);
+    offsets.reserve(count);
+    lengths.reserve(count);
+    payloads.reserve(count);
+}
+
+void TokenBuffer::clear() {
+    kinds.clear();
+    offsets.clear();
+    lengths.clear();
+    payloads.clear();
+    detached.clear();
+    literals.clear();
+}
+
+void TokenBuffer::push_back(const Token& token) {
+    uint8_t kind = static_cast<uint8_t>(token.type);
+    uint32_t payload = token.name;
+
+    const char* source = file->getText().data() + token.offset;
+    bool isSlice = token.value.size() == token.length && (token.length == 0 || token.value.data() == source);
+    // String and char literals without escapes: the value is the lexeme
+    // minus its quotes.
+    bool isQuotedSlice = token.length >= 2 && token.value.size() == token.length - 2 &&
+                         token.value.data() == source + 1;
+    if (isQuotedSlice) {
+        kind |= QUOTED;
+    } else if (!isSlice) {
+        kind |= DETACHED;
+        payload = static_cast<uint32_t>(detached.size());
+        detached.push_back(token.value);
+    } else if (token.type == TokenType::LITERAL_INT) {
+        payload = static_cast<uint32_t>(literals.size());
+        literals.push_back(token.literal);
+    }
+
+    kinds.push_back(kind);
+    offsets.push_back(token.offset);
+    lengths.push_back(token.length);
+    payloads.push_back(payload);
+}
+
+void TokenBuffer::appendShifted(const TokenBuffer& from, size_t begin, size_t end, int64_t delta, SourceFile& file) {
+    kinds.insert(kinds.end(), from.kinds.begin() + begin, from.kinds.begin() + end);
+    lengths.insert(lengths.end(), from.lengths.begin() + begin, from.lengths.begin() + end);
+    for (size_t i = begin; i < end; i++) {
+        offsets.push_back(static_cast<uint32_t>(from.offsets[i] + delta));
+        if (from.kinds[i] & DETACHED) {
+            // The old value may live in the old file's arena.
+            payloads.push_back(static_cast<uint32_t>(detached.size()));
+            detached.push_back(file.storeDecoded(from.detached[from.payloads[i]]));
+        } else if (from.kinds[i] == static_cast<uint8_t>(TokenType::LITERAL_INT)) {
+            payloads.push_back(static_cast<uint32_t>(literals.size()));
+            literals.push_back(from.literals[from.payloads[i]]);
+        } else {
+            payloads.push_back(from.payloads[i]);
+        }
+    }
+}
+
+std::string_view TokenBuffer::value(size_t index) const {
+    if (kinds[index] & DETACHED) {
+        return detached[payloads[index]];
+    }
+    if (kinds[index] & QUOTED) {
+        return file->getText().substr(offsets[index] + 1, lengths[index] - 2);
+    }
+    return file->getText().substr(offsets[index], lengths[index]);
+}
+
+uint64_t TokenBuffer::literal(size_t index) const {
+    switch (kind(index)) {
+        case TokenType::LITERAL_INT: return literals[payloads[index]];
+        case TokenType::LITERAL_CHAR: return static_cast<unsigned char>(value(index)[0]);
+        case TokenType::KEYWORD_TRUE: return 1;
+        default: return 0;
+    }
+}
+
+Token TokenBuffer::operator[](size_t index) const {
+    TokenType type = kind(index);
+    bool named = !(kinds[index] & DETACHED) && type != TokenType::LITERAL_INT;
+    NameId name = named ? payloads[index] : INVALID_NAME;
+    return Token(type, value(index), file, offsets[index], lengths[index], name, literal(index));
+}
@@ -0,0 +1,57 @@
+#ifndef TOKENBUFFER_H
+#define TOKENBUFFER_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "source.h"
+#include "token.h"
+
+// Tokens of one file stored as parallel arrays: a 1-byte kind, the 32-bit
+// source offset and length, and a 32-bit payload (the interned name). That is
+// 13 bytes per token; Token objects are rebuilt on demand when indexed.
+// String and char literals without escapes are the lexeme minus its quotes.
+// Values that are not a slice of the source (decoded escapes, error
+// messages) are kept in a small side table, and so are the 64-bit values of
+// integer literals.
+class TokenBuffer {
+public:
+    explicit TokenBuffer(const SourceFile& file) : file(&file) {}
+
+    size_t size() const { return kinds.size(); }
+    bool empty() const { return kinds.empty(); }
+    void reserve(size_t count);
+    void clear();
+    void push_back(const Token& token);
+    // Copies tokens [begin, end) of another buffer, moving their offsets by
+    // delta. Used when re-lexing an edited file; `file` must be this buffer's.
+    void appendShifted(const TokenBuffer& from, size_t begin, size_t end, int64_t delta, SourceFile& file);
+
+    TokenType kind(size_t index) const { return static_cast<TokenType>(kinds[index] & ~(DETACHED | QUOTED)); }
+    uint32_t offset(size_t index) const { return offsets[index]; }
+    uint32_t length(size_t index) const { return lengths[index]; }
+    uint32_t end(size_t index) const { return offsets[index] + lengths[index]; }
+    std::string_view value(size_t index) const;
+    uint64_t literal(size_t index) const;
+
+    Token operator[](size_t index) const;
+    Token back() const { return (*this)[size() - 1]; }
+
+    const SourceFile& getFile() const { return *file; }
+
+private:
+    static constexpr uint8_t DETACHED = 0x80;
+    static constexpr uint8_t QUOTED = 0x40; // value is the lexeme without its first and last byte
+
+    const SourceFile* file;
+    std::vector<uint8_t> kinds;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> lengths;
+    std::vector<uint32_t> payloads; // NameId, or an index into detached or literals
+    std::vector<std::string_view> detached;
+    std::vector<uint64_t> literals;
+};
+
+static_assert(static_cast<unsigned>(TokenType::ERROR) < 0x40, "TokenType must fit in the kind byte next to its flags");
+
+#endif
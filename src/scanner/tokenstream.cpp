@@ -0,0 +1,80 @@
+#include "tokenstream.h"
+
+static_assert((TokenStream::RING_SIZE & (TokenStream::RING_SIZE - 1)) == 0, "RING_SIZE must be a power of two");
+
+TokenStream::TokenStream(Scanner& scanner)
+    : scanner(&scanner), ring(RING_SIZE, Token(TokenType::ERROR, "", nullptr, 0, 0)) {}
+
+TokenStream::TokenStream(const TokenBuffer& tokens) : TokenStream(tokens, 0, tokens.size()) {}
+
+TokenStream::TokenStream(const TokenBuffer& tokens, size_t begin, size_t end)
+    : replay(&tokens), replayIndex(begin), replayEnd(end),
+      ring(RING_SIZE, Token(TokenType::ERROR, "", nullptr, 0, 0)), head(begin), filled(begin) {
+    if (end < tokens.size()) {
+        endOffset = tokens.offset(end);
+    } else if (!tokens.empty()) {
+        endOffset = tokens.offset(tokens.size() - 1);
+    }
+}
+
+const Token& TokenStream::peek(size_t ahead) {
+    while (filled <= head + ahead) {
+        ring[filled & (RING_SIZE - 1)] = next();
+        filled++;
+    }
+    return ring[(head + ahead) & (RING_SIZE - 1)];
+}
+
+TokenType TokenStream::peekKind(size_t ahead) {
+    if (!replay) {
+        return peek(ahead).type;
+    }
+    if (head + ahead >= replayEnd) {
+        return TokenType::END_OF_FILE;
+    }
+    return replay->kind(head + ahead);
+}
+
+const Token& TokenStream::previous() const {
+    return ring[(head - 1) & (RING_SIZE - 1)];
+}
+
+void TokenStream::advance() {
+    peek();
+    head++;
+}
+
+bool TokenStream::skipBlock() {
+    if (!replay) {
+        return false;
+    }
+    size_t depth = 0;
+    size_t index = head;
+    for (; index < replayEnd; index++) {
+        TokenType kind = replay->kind(index);
+        if (kind == TokenType::LEFT_BRACE) {
+            depth++;
+        } else if (kind == TokenType::RIGHT_BRACE) {
+            if (depth == 0) break;
+            depth--;
+        }
+    }
+    // Tokens already in the ring stay valid; the rest are pulled from here on.
+    head = index;
+    if (filled < head) {
+        filled = head;
+        replayIndex = head;
+    }
+    return index < replayEnd;
+}
+
+// Both producers keep returning END_OF_FILE once the input is exhausted.
+Token TokenStream::next() {
+    if (scanner) {
+        return scanner->getToken();
+    }
+    if (replayIndex >= replayEnd) {
+        return Token(TokenType::END_OF_FILE, "", &replay->getFile(), endOffset, 0);
+    }
+    return (*replay)[replayIndex++];
+}
@@ -0,0 +1,53 @@
+#ifndef TOKENSTREAM_H
+#define TOKENSTREAM_H
+
+#include <vector>
+#include "scanner.h"
+#include "token.h"
+#include "tokenbuffer.h"
+
+// Pull-based token source for the parser. Tokens are produced on demand,
+// either by a Scanner or by replaying an already scanned buffer, and only a
+// small ring of them is kept: the current token, the previous one and a few
+// tokens of lookahead. Memory use does not depend on the size of the input.
+// When replaying a buffer, kind lookups read the buffer's kind array directly
+// and a Token is only built once the parser actually looks at it.
+class TokenStream {
+public:
+    static constexpr size_t RING_SIZE = 4; // power of two
+
+    explicit TokenStream(Scanner& scanner);
+    explicit TokenStream(const TokenBuffer& tokens);
+    // Replays tokens [begin, end) of the buffer and then END_OF_FILE.
+    TokenStream(const TokenBuffer& tokens, size_t begin, size_t end);
+
+    // ahead must be smaller than RING_SIZE - 1 so the previous token survives.
+    const Token& peek(size_t ahead = 0);
+    // Same as peek(ahead).type, for the parser's lookahead tests.
+    TokenType peekKind(size_t ahead = 0);
+    const Token& previous() const;
+    void advance();
+
+    // Index of the current token in the replayed buffer.
+    size_t position() const { return head; }
+    // Replay only: moves to the '}' that closes the block the current token
+    // is in, reading just the buffer's kind array, so the skipped tokens are
+    // never built. previous() is stale until the next advance(). Returns
+    // false, at the end of the range, if the block is never closed.
+    bool skipBlock();
+
+private:
+    Token next();
+
+    Scanner* scanner = nullptr;
+    const TokenBuffer* replay = nullptr;
+    size_t replayIndex = 0;
+    size_t replayEnd = 0;
+    uint32_t endOffset = 0; // where the END_OF_FILE after the range sits
+
+    std::vector<Token> ring;
+    size_t head = 0;   // absolute index of the current token
+    size_t filled = 0; // number of tokens pulled so far
+};
+
+#endif
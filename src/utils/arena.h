@@ -0,0 +1,53 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Bump allocator: memory is handed out from large blocks and released all at
+// once when the arena is destroyed.
+class BumpArena {
+public:
+    explicit BumpArena(size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+    BumpArena(const BumpArena&) = delete;
+    BumpArena& operator=(const BumpArena&) = delete;
+    BumpArena(BumpArena&&) = default;
+    BumpArena& operator=(BumpArena&&) = default;
+
+    // Blocks come from operator new, so any alignment up to max_align_t holds.
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        size_t offset = (used + alignment - 1) & ~(alignment - 1);
+        if (blocks.empty() || offset + size > capacity) {
+            capacity = size > blockSize ? size : blockSize;
+            blocks.push_back(std::make_unique<char[]>(capacity));
+            offset = 0;
+        }
+        used = offset + size;
+        return blocks.back().get() + offset;
+    }
+
+    // Releases every block; the arena can be used again afterwards.
+    void clear() {
+        blocks.clear();
+        capacity = 0;
+        used = 0;
+    }
+
+    std::string_view copyString(std::string_view text) {
+        if (text.empty()) return std::string_view();
+        char* memory = static_cast<char*>(allocate(text.size(), 1));
+        std::memcpy(memory, text.data(), text.size());
+        return std::string_view(memory, text.size());
+    }
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t blockSize;
+    size_t capacity = 0;
+    size_t used = 0;
+};
+
+#endif
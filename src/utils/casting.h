@@ -0,0 +1,51 @@
+#ifndef CASTING_H
+#define CASTING_H
+
+#include <cassert>
+#include <type_traits>
+
+// Checked downcasts without RTTI, in the style of LLVM. A class hierarchy
+// stores a kind tag in its base and every class that can be a target gives
+// itself a `static bool classof(const Base*)` that checks the tag, so a test
+// is one integer compare. The project builds with -fno-rtti and uses these
+// instead of dynamic_cast.
+//
+//   isa<To>(p)      true if p points to a To.
+//   cast<To>(p)     p as a To; p must be one.
+//   dyn_cast<To>(p) p as a To, or nullptr if it is not one or p is null.
+
+namespace casting_detail {
+    // To with the constness of From.
+    template <typename To, typename From>
+    using Like = std::conditional_t<std::is_const_v<From>, const To, To>;
+}
+
+template <typename To, typename From>
+bool isa(const From* value) {
+    assert(value && "isa<> used on a null pointer");
+    return To::classof(value);
+}
+
+template <typename To, typename From>
+bool isa(const From& value) {
+    return To::classof(&value);
+}
+
+template <typename To, typename From>
+casting_detail::Like<To, From>* cast(From* value) {
+    assert(isa<To>(value) && "cast<> argument of incompatible type");
+    return static_cast<casting_detail::Like<To, From>*>(value);
+}
+
+template <typename To, typename From>
+casting_detail::Like<To, From>& cast(From& value) {
+    assert(isa<To>(value) && "cast<> argument of incompatible type");
+    return static_cast<casting_detail::Like<To, From>&>(value);
+}
+
+template <typename To, typename From>
+casting_detail::Like<To, From>* dyn_cast(From* value) {
+    return value && To::classof(value) ? static_cast<casting_detail::Like<To, From>*>(value) : nullptr;
+}
+
+#endif
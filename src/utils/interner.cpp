@@ -0,0 +1,48 @@
+#include "interner.h"
+#include "../scanner/token.h"
+
+namespace {
+
+constexpr NameId KEYWORD_COUNT = static_cast<NameId>(std::size(TokenTables::keywords));
+
+}
+
+StringInterner& StringInterner::getInstance() {
+    static StringInterner instance;
+    return instance;
+}
+
+// Dynamic ids start after the keywords; the low bits select the shard.
+NameId StringInterner::intern(std::string_view text) {
+    TokenType keyword = lookupKeyword(text);
+    if (keyword != TokenType::IDENTIFIER) {
+        return keywordNameId(keyword);
+    }
+
+    size_t shardIndex = std::hash<std::string_view>()(text) & (SHARD_COUNT - 1);
+    Shard& shard = shards[shardIndex];
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.ids.find(text);
+    if (it != shard.ids.end()) {
+        return it->second;
+    }
+
+    std::string_view stored = shard.storage.copyString(text);
+    NameId id = KEYWORD_COUNT + static_cast<NameId>((shard.names.size() << SHARD_BITS) | shardIndex);
+    shard.names.push_back(stored);
+    shard.ids.emplace(stored, id);
+    return id;
+}
+
+std::string_view StringInterner::lookup(NameId id) const {
+    if (id < KEYWORD_COUNT) {
+        return TokenTables::keywords[id].text;
+    }
+    NameId local = id - KEYWORD_COUNT;
+    const Shard& shard = shards[local & (SHARD_COUNT - 1)];
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    size_t index = local >> SHARD_BITS;
+    return index < shard.names.size() ? shard.names[index] : std::string_view();
+}
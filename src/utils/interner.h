@@ -0,0 +1,50 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "arena.h"
+
+// Stable 32-bit id of an interned name. Equal names always get equal ids, so
+// later phases compare and hash integers instead of strings.
+using NameId = uint32_t;
+
+constexpr NameId INVALID_NAME = UINT32_MAX;
+
+// Process-wide name table shared by the scanner, the AST and the symbol
+// tables. Keywords have fixed ids (see keywordNameId in token.h); every other
+// name goes to one of several shards, each behind its own mutex, so parallel
+// lexers rarely contend. Interned text lives until the program exits.
+class StringInterner {
+public:
+    // (singleton)
+    static StringInterner& getInstance();
+
+    NameId intern(std::string_view text);
+    std::string_view lookup(NameId id) const;
+
+private:
+    static constexpr unsigned SHARD_BITS = 4;
+    static constexpr size_t SHARD_COUNT = size_t(1) << SHARD_BITS;
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string_view, NameId> ids;
+        std::vector<std::string_view> names; // indexed by id >> SHARD_BITS
+        BumpArena storage{16 * 1024};
+    };
+
+    std::array<Shard, SHARD_COUNT> shards;
+
+    StringInterner() = default;
+    ~StringInterner() = default;
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+};
+
+#endif
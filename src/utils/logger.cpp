@@ -8,12 +8,10 @@ Logger& Logger::getInstance() {
 }
 
 void Logger::setLogLevel(LogLevel level) {
-    std::lock_guard<std::mutex> lock(logMutex);
     currentLogLevel = level;
 }
 
 void Logger::setActive(bool active) {
-    std::lock_guard<std::mutex> lock(logMutex);
     isActive = active;
 }
 
@@ -23,12 +21,11 @@ void Logger::setOutputStream(std::ostream& stream) {
 }
 
 void Logger::log(LogLevel level, const std::string& message) {
+    if (!isEnabled(level)) return;
     std::lock_guard<std::mutex> lock(logMutex);
-    if (isActive && level >= currentLogLevel) {
-        // std::string time = getCurrentTime();
-        // *outputStream << "[" << time << "] [" << logLevelToString(level) << "]: " << message << std::endl;
-        *outputStream << "[" << logLevelToString(level) << "]: " << message << std::endl;
-    }
+    // std::string time = getCurrentTime();
+    // *outputStream << "[" << time << "] [" << logLevelToString(level) << "]: " << message << std::endl;
+    *outputStream << "[" << logLevelToString(level) << "]: " << message << std::endl;
 }
 
 void Logger::debug(const std::string& message) {
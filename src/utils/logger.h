@@ -1,6 +1,7 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <atomic>
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -8,6 +9,13 @@
 #include <ctime>
 #include <mutex>
 
+// Messages below this level are compiled out by the LOG_* macros. Values
+// follow Logger::LogLevel (0 = DEBUG ... 3 = ERROR); release builds set it
+// to 2 so debug and info call sites disappear.
+#ifndef BMINOR_MIN_LOG_LEVEL
+#define BMINOR_MIN_LOG_LEVEL 0
+#endif
+
 class Logger {
 public:
     enum class LogLevel {
@@ -27,6 +35,15 @@ public:
 
     void setOutputStream(std::ostream& outputStream);
 
+    // Lock-free check done by the LOG_* macros before the message is built.
+    bool isEnabled(LogLevel level) const {
+        return isActive.load(std::memory_order_relaxed) && level >= currentLogLevel.load(std::memory_order_relaxed);
+    }
+
+    static constexpr bool isCompiledIn(LogLevel level) {
+        return static_cast<int>(level) >= BMINOR_MIN_LOG_LEVEL;
+    }
+
     void log(LogLevel level, const std::string& message);
     void debug(const std::string& message);
     void info(const std::string& message);
@@ -34,8 +51,8 @@ public:
     void error(const std::string& message);
 
 private:
-    LogLevel currentLogLevel;
-    bool isActive;
+    std::atomic<LogLevel> currentLogLevel;
+    std::atomic<bool> isActive;
     std::ostream* outputStream;
     std::mutex logMutex;
 
@@ -48,4 +65,18 @@ private:
     std::string logLevelToString(LogLevel level);
 };
 
+// The message expression is only evaluated when the level is compiled in and
+// enabled at runtime, so tracing costs one branch (or nothing) when it is off.
+#define LOG_AT(level, message)                                                         \
+    do {                                                                               \
+        if (Logger::isCompiledIn(level) && Logger::getInstance().isEnabled(level)) {   \
+            Logger::getInstance().log(level, message);                                 \
+        }                                                                              \
+    } while (0)
+
+#define LOG_DEBUG(message) LOG_AT(Logger::LogLevel::DEBUG, message)
+#define LOG_INFO(message) LOG_AT(Logger::LogLevel::INFO, message)
+#define LOG_WARNING(message) LOG_AT(Logger::LogLevel::WARNING, message)
+#define LOG_ERROR(message) LOG_AT(Logger::LogLevel::ERROR, message)
+
 #endif
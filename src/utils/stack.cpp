@@ -0,0 +1,77 @@
+#include "stack.h"
+#include <exception>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#define BMINOR_HAS_PTHREAD 1
+#endif
+
+namespace {
+
+#ifdef BMINOR_HAS_PTHREAD
+struct SegmentTask {
+    const std::function<void()>* work;
+    std::exception_ptr error;
+};
+
+void* runSegmentTask(void* argument) {
+    SegmentTask* task = static_cast<SegmentTask*>(argument);
+    try {
+        (*task->work)();
+    } catch (...) {
+        task->error = std::current_exception();
+    }
+    return nullptr;
+}
+#endif
+
+}
+
+namespace Stack {
+namespace detail {
+
+thread_local uintptr_t limit = 0;
+
+uintptr_t computeLimit() {
+#if defined(__linux__)
+    pthread_attr_t attributes;
+    if (pthread_getattr_np(pthread_self(), &attributes) == 0) {
+        void* base = nullptr;
+        size_t size = 0;
+        int status = pthread_attr_getstack(&attributes, &base, &size);
+        pthread_attr_destroy(&attributes);
+        if (status == 0 && base && size > RED_ZONE) {
+            return reinterpret_cast<uintptr_t>(base) + RED_ZONE;
+        }
+    }
+#elif defined(__APPLE__)
+    pthread_t self = pthread_self();
+    uintptr_t top = reinterpret_cast<uintptr_t>(pthread_get_stackaddr_np(self));
+    size_t size = pthread_get_stacksize_np(self);
+    if (size > RED_ZONE) return top - size + RED_ZONE;
+#endif
+    // Unknown bounds: never switch stacks.
+    return 1;
+}
+
+void runOnSegment(const std::function<void()>& work) {
+#ifdef BMINOR_HAS_PTHREAD
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setstacksize(&attributes, SEGMENT_SIZE);
+    SegmentTask task{&work, nullptr};
+    pthread_t thread;
+    int status = pthread_create(&thread, &attributes, runSegmentTask, &task);
+    pthread_attr_destroy(&attributes);
+    if (status == 0) {
+        pthread_join(thread, nullptr);
+        if (task.error) std::rethrow_exception(task.error);
+        return;
+    }
+#endif
+    // No thread for a new segment: keep going on the current stack.
+    work();
+}
+
+}
+}
@@ -0,0 +1,52 @@
+#ifndef STACK_H
+#define STACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// The parser and the AST visitors recurse once per nesting level of the
+// input, so machine-generated programs can run them off the end of the
+// thread's stack. Recursive entry points check isLow() and, when the current
+// stack is nearly used up, continue on a new segment: the work runs on a
+// helper thread with a fresh SEGMENT_SIZE stack while the caller waits. Depth
+// is then limited by memory instead of by the initial stack size.
+namespace Stack {
+    // Stack that must still be free when isLow() says no. Code between two
+    // checks has to fit in it.
+    constexpr size_t RED_ZONE = 256 * 1024;
+    constexpr size_t SEGMENT_SIZE = 64 * 1024 * 1024;
+
+    namespace detail {
+        // Lowest address the current thread may reach before switching, or 0
+        // until it is first needed. Stacks are assumed to grow downwards.
+        extern thread_local uintptr_t limit;
+        uintptr_t computeLimit();
+        void runOnSegment(const std::function<void()>& work);
+    }
+
+    inline bool isLow() {
+        if (detail::limit == 0) detail::limit = detail::computeLimit();
+        char marker;
+        return reinterpret_cast<uintptr_t>(&marker) < detail::limit;
+    }
+
+    // Runs `work` on a new stack segment and returns its result. Exceptions
+    // thrown by `work` are rethrown here.
+    template <typename Work>
+    auto onNewSegment(Work&& work) -> decltype(work()) {
+        using Result = decltype(work());
+        if constexpr (std::is_void_v<Result>) {
+            detail::runOnSegment(work);
+        } else {
+            std::optional<Result> result;
+            detail::runOnSegment([&] { result.emplace(work()); });
+            return std::move(*result);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,557 @@
+// Differential checks for the scanner and parser entry points that are not
+// plain scan() + parse(). Each check builds the same input both ways and
+// compares the tokens, or the trees, declaration extents and syntax errors.
+//
+//   parser_checks scan       Scanner::scanParallel() with 2, 3 and 4 chunks,
+//                            split inside long strings and comments
+//   parser_checks parallel   parseParallel() on a large generated program,
+//                            with and without broken declarations
+//   parser_checks reparse    Scanner::relex() + Parser::reparse() after
+//                            chains of random edits
+//   parser_checks flat       the JSON dump written from a FlatAST against
+//                            the one written by visiting the tree
+
+#include "../src/scanner/scanner.h"
+#include "../src/scanner/source.h"
+#include "../src/parser/parser.h"
+#include "../src/AST/AST.h"
+#include "../src/AST/ASTPrinterJson.h"
+#include "../src/AST/FlatAST.h"
+#include "../src/AST/StaticVisitor.h"
+#include "../src/utils/logger.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Serializes a tree as nested "(Kind token children...)" groups. Only token
+// values go in: trees from reparse() keep the offsets of the old text.
+class TreeDump final : public ASTNodeVisitor, public StaticVisitor<TreeDump> {
+public:
+    std::string text;
+
+    void Visit(ProgramNode& node) override {
+        Open("Program");
+        for (ASTNode* decl : node.declarations) Child(decl);
+        for (const SourceRange& extent : node.extents) {
+            text += " [" + std::to_string(extent.begin) + "," + std::to_string(extent.end) + ")";
+        }
+        Close();
+    }
+    void Visit(DeclarationNode& node) override { Open("Declaration"); Close(); }
+    void Visit(VarDeclarationNode& node) override {
+        Open("VarDeclaration", node.type.value);
+        Value(node.identifier.value);
+        Child(node.expression);
+        Close();
+    }
+    void Visit(FunctionDeclarationNode& node) override {
+        Open("FunctionDeclaration", node.returnType.value);
+        Value(node.functionName.value);
+        for (ParamNode* param : node.parameters) Child(param);
+        Child(node.Body());
+        Close();
+    }
+    void Visit(ParamNode& node) override {
+        Open("Param", node.type.value);
+        Value(node.identifier.value);
+        Close();
+    }
+    void Visit(ParamListNode& node) override {
+        Open("ParamList");
+        for (ParamNode* param : node.parameters) Child(param);
+        Close();
+    }
+    void Visit(ExpressionNode& node) override { Open("Expression"); Close(); }
+    void Visit(AssignmentNode& node) override {
+        Open("Assignment", node.op.value);
+        Child(node.left);
+        Child(node.right);
+        Close();
+    }
+    void Visit(BinaryOperationNode& node) override { Binary("BinaryOperation", node); }
+    void Visit(RelationalNode& node) override { Binary("Relational", node); }
+    void Visit(EqualityNode& node) override { Binary("Equality", node); }
+    void Visit(LogicalOrNode& node) override { Binary("LogicalOr", node); }
+    void Visit(LogicalAndNode& node) override { Binary("LogicalAnd", node); }
+    void Visit(UnaryOperationNode& node) override {
+        Open("UnaryOperation", node.op.value);
+        Child(node.expr);
+        Close();
+    }
+    void Visit(LiteralNode& node) override {
+        Open("Literal", node.literal.value);
+        Value(std::to_string(node.value));
+        Close();
+    }
+    void Visit(IdentifierNode& node) override { Open("Identifier", node.identifier.value); Close(); }
+    void Visit(TypeNode& node) override { Open(node.isArray ? "ArrayType" : "Type", node.type.value); Close(); }
+    void Visit(StatementNode& node) override { Open("Statement"); Close(); }
+    void Visit(IfStatementNode& node) override {
+        Open("If");
+        Child(node.condition);
+        Child(node.ifBody);
+        Child(node.elseBody);
+        Close();
+    }
+    void Visit(ForStatementNode& node) override {
+        Open("For");
+        Child(node.init);
+        Child(node.condition);
+        Child(node.increment);
+        Child(node.body);
+        Close();
+    }
+    void Visit(ReturnStatementNode& node) override { Open("Return"); Child(node.expression); Close(); }
+    void Visit(PrintStatementNode& node) override { Open("Print"); Child(node.exprList); Close(); }
+    void Visit(ExpressionStatementNode& node) override { Open("ExpressionStatement"); Child(node.expression); Close(); }
+    void Visit(CompoundStatementNode& node) override {
+        Open("Compound");
+        for (ASTNode* stmt : node.statements) Child(stmt);
+        Close();
+    }
+    void Visit(ExprListNode& node) override {
+        Open("ExprList");
+        for (ASTNode* expr : node.expressions) Child(expr);
+        Close();
+    }
+    void Visit(FunctionCallNode& node) override {
+        Open("FunctionCall", node.functionName->identifier.value);
+        Child(node.arguments);
+        Close();
+    }
+    void Visit(IndexingNode& node) override {
+        Open("Indexing");
+        Child(node.base);
+        Child(node.index);
+        Close();
+    }
+
+private:
+    void Open(const char* kind, std::string_view value = {}) {
+        text += '(';
+        text += kind;
+        if (!value.empty()) Value(value);
+    }
+    void Value(std::string_view value) {
+        text += " '";
+        text += value;
+        text += '\'';
+    }
+    void Child(ASTNode* node) {
+        text += ' ';
+        if (node) {
+            Dispatch(*node);
+        } else {
+            text += '_';
+        }
+    }
+    void Close() { text += ')'; }
+    void Binary(const char* kind, BinaryOperationNode& node) {
+        Open(kind, node.op.value);
+        Child(node.left);
+        Child(node.right);
+        Close();
+    }
+};
+
+// Everything a parse produced: the tree, or NULL, then one line per error.
+std::string describe(Parser& parser) {
+    TreeDump dump;
+    if (ProgramNode* ast = parser.getAST()) {
+        dump.Dispatch(*ast);
+    } else {
+        dump.text = "NULL";
+    }
+    for (const SyntaxError& error : parser.getErrors()) {
+        dump.text += "\n" + std::to_string(error.line) + ": " + error.message;
+    }
+    return dump.text;
+}
+
+// A program of `count` top-level declarations in the shapes the grammar
+// accepts. When `errorEvery` is not 0, every errorEvery-th declaration is
+// replaced by one with a syntax error, some of them inside a function body.
+std::string generateProgram(size_t count, size_t errorEvery, unsigned seed) {
+    // '@' stands for the declaration number.
+    static const char* const broken[] = {
+        "integer broken@(integer a integer b) {\n    return a;\n}\n",
+        "integer missing@ = ;\n",
+        "integer body@() {\n    x = = 1;\n    return 0;\n}\n",
+        "integer trailing@ = 1 + ;\n",
+        "integer paren@() {\n    if (x < 1 {\n        x = 2;\n    }\n    return x;\n}\n",
+        "integer semicolon@(integer a; integer b) {\n    return a;\n}\n",
+        "integer stray@ = 1; }\n",
+    };
+    std::mt19937 random(seed);
+    std::string text = "// generated\nchar gc = 'k';\nstring gs = \"hi\\n\\\"there\\\"\";\ninteger gi = 42;\n\n";
+    for (size_t i = 0; i < count; i++) {
+        std::string n = std::to_string(i);
+        if (errorEvery != 0 && i % errorEvery == errorEvery - 1) {
+            std::string pattern = broken[random() % std::size(broken)];
+            pattern.replace(pattern.find('@'), 1, n);
+            text += pattern;
+            continue;
+        }
+        switch (random() % 3) {
+            case 0:
+                text += "integer g" + n + " = " + std::to_string(random() % 1000) + " * (gi + 3);\n";
+                break;
+            case 1:
+                text += "boolean b" + n + "(integer a, char c) {\n"
+                        "    if (a < 10 && c != 'x') {\n"
+                        "        print(\"small\", a);\n"
+                        "        return true;\n"
+                        "    }\n"
+                        "    return !(a == 0) || false;\n"
+                        "}\n";
+                break;
+            default:
+                text += "integer fn" + n + "(integer a, integer b, char c) {\n"
+                        "    // comment line with stuff + - * / \"quoted\"\n"
+                        "    integer x = a + b * " + n + " - (a % 3);\n"
+                        "    boolean t = x >= 10 && a != b || !(a == b);\n"
+                        "    if (x < 100) {\n"
+                        "        x = x + 1;\n"
+                        "        print(x, \"tab\\there\", 'c', '\\n');\n"
+                        "    } else {\n"
+                        "        x = x - 1;\n"
+                        "    }\n"
+                        "    for (a = 0; a <= b; a = a + 1;) {\n"
+                        "        x = x + fn0(a, b, c);\n"
+                        "    }\n"
+                        "    return x;\n"
+                        "}\n";
+                break;
+        }
+        text += "\n";
+    }
+    return text;
+}
+
+// parseParallel() must match parse() on the same buffer for any number of
+// threads, in both normal and skeleton mode. The thread count sets where the
+// ranges are cut, so each case is parsed with several.
+bool checkParallel() {
+    struct Case {
+        const char* name;
+        size_t errorEvery;
+        bool skeleton;
+    };
+    const Case cases[] = {
+        {"clean", 0, false},
+        {"clean skeleton", 0, true},
+        {"broken", 7, false},
+        {"broken skeleton", 7, true},
+    };
+    const unsigned threadCounts[] = {2, 3, 4, 7, 16, 61};
+
+    bool ok = true;
+    SourceManager sources;
+    for (const Case& test : cases) {
+        SourceFile* file = sources.addBuffer(test.name, generateProgram(3000, test.errorEvery, 18));
+        Scanner scanner(*file);
+        scanner.scan();
+
+        ASTContext sequentialContext;
+        Parser sequential(sequentialContext, scanner.getTokens());
+        sequential.setSkeleton(test.skeleton);
+        sequential.parse();
+        const std::string expected = describe(sequential);
+
+        std::cout << "parallel " << test.name << ": " << scanner.getTokens().size() << " tokens, "
+                  << sequential.getErrors().size() << " errors,";
+        for (unsigned threads : threadCounts) {
+            ASTContext parallelContext;
+            Parser parallel(parallelContext, scanner.getTokens());
+            parallel.setSkeleton(test.skeleton);
+            parallel.parseParallel(threads);
+
+            bool same = describe(parallel) == expected;
+            std::cout << " " << threads << " threads " << (same ? "same" : "DIFFERENT");
+            ok = ok && same;
+        }
+        std::cout << "\n";
+    }
+    return ok;
+}
+
+// Input for checkScan(): generated declarations between comment and string
+// lines of several kilobytes, which take up most of the file, so the points
+// where scanParallel() splits it fall inside one of them. It also has escapes,
+// UTF-8 text and integers too large for 64 bits.
+std::string generateScanInput(size_t minimumSize) {
+    std::string comment = "//";
+    while (comment.size() < 12000) comment += " comentario con ñandú y ünïcode, \"sin string\", 'x', 123 + 4;";
+    std::string literal;
+    while (literal.size() < 12000) literal += "texto con \\\"escapes\\\" \\t\\n y ñandú // sin comentario ";
+
+    std::string text;
+    for (unsigned part = 0; text.size() < minimumSize; part++) {
+        std::string n = std::to_string(part);
+        text += generateProgram(20, 3, part);
+        text += comment + "\n";
+        text += "string s" + n + " = \"" + literal + "\";\n";
+        text += "integer big" + n + " = 123456789012345678901234567890; // " + literal + "\n";
+    }
+    return text;
+}
+
+// The token at `index` of each buffer, with everything the parser reads.
+bool sameToken(const TokenBuffer& a, const TokenBuffer& b, size_t index) {
+    Token x = a[index];
+    Token y = b[index];
+    return x.type == y.type && x.offset == y.offset && x.length == y.length && x.value == y.value &&
+           x.literal == y.literal && x.name == y.name;
+}
+
+// scanParallel() must produce exactly the tokens of scan(). Chunks start at
+// the first line after size / n * i, so each of those points is also checked
+// to be inside a string or a comment.
+bool checkScan() {
+    SourceManager sources;
+    SourceFile* file = sources.addBuffer("scan", generateScanInput(1536 * 1024));
+    std::string_view text = file->getText();
+    Scanner sequential(*file);
+    sequential.scan();
+    const TokenBuffer& expected = sequential.getTokens();
+
+    bool ok = true;
+    for (unsigned chunks = 2; chunks <= 4; chunks++) {
+        for (unsigned i = 1; i < chunks; i++) {
+            size_t split = text.size() / chunks * i;
+            size_t lineStart = text.rfind('\n', split) + 1;
+            bool inComment = text.compare(lineStart, 2, "//") == 0 ||
+                             text.substr(lineStart, split - lineStart).find("; //") != std::string_view::npos;
+            bool inString = false;
+            for (size_t t = 0; t < expected.size() && expected.offset(t) <= split; t++) {
+                if (expected.kind(t) == TokenType::LITERAL_STRING && split < expected.end(t)) inString = true;
+            }
+            if (!inComment && !inString) {
+                std::cout << "scan " << chunks << " chunks: split " << i << " is not in a string or comment\n";
+                ok = false;
+            }
+        }
+
+        Scanner parallel(*file);
+        parallel.scanParallel(chunks);
+        const TokenBuffer& tokens = parallel.getTokens();
+        size_t mismatch = 0;
+        while (mismatch < expected.size() && mismatch < tokens.size() && sameToken(expected, tokens, mismatch)) {
+            mismatch++;
+        }
+        bool same = mismatch == expected.size() && mismatch == tokens.size();
+        std::cout << "scan " << chunks << " chunks: " << expected.size() << " tokens, ";
+        if (same) {
+            std::cout << "same\n";
+        } else {
+            std::cout << "DIFFERENT at token " << mismatch << "\n";
+        }
+        ok = ok && same;
+    }
+    return ok;
+}
+
+// Random edits to `text`: one to three of them, sorted and not overlapping.
+// Most insert a small piece of code at a random offset or at the next
+// whitespace; one in four also removes a few bytes.
+std::vector<SourceEdit> randomEdits(std::string_view text, std::mt19937& random) {
+    static const char* const snippets[] = {
+        "", "x", ";", "}", "{", " ", "integer y = 3;", "\n", "+ 1", "integer g() { return 1; }",
+        "(", ")", "a = b;", "//c\n", "print(1);", "  ", "\n\n", "integer q;",
+    };
+    size_t size = text.size();
+    std::vector<size_t> offsets;
+    for (size_t count = random() % 3 + 1; count > 0; count--) {
+        size_t offset = size ? random() % size : 0;
+        if (random() % 2) {
+            while (offset < size && !std::isspace(static_cast<unsigned char>(text[offset]))) offset++;
+        }
+        offsets.push_back(std::min(offset, size ? size - 1 : 0));
+    }
+    std::sort(offsets.begin(), offsets.end());
+
+    std::vector<SourceEdit> edits;
+    size_t next = 0;
+    for (size_t offset : offsets) {
+        if (offset < next) continue;
+        size_t removed = random() % 4 ? 0 : std::min<size_t>(random() % 6, size - offset);
+        edits.push_back(SourceEdit{offset, removed, snippets[random() % std::size(snippets)]});
+        next = offset + removed + 1;
+    }
+    return edits;
+}
+
+// relex() + reparse() of an edited file must match scan() + parse() of the
+// same text. Each round edits the result of the previous one, so reused
+// declarations pile up; a round that leaves no tree starts over from the
+// generated program.
+bool checkReparse() {
+    const unsigned seeds[] = {1, 2, 3, 4, 5};
+    const int rounds = 300;
+
+    bool ok = true;
+    for (unsigned seed : seeds) {
+        SourceManager sources;
+        SourceFile* base = sources.addBuffer("reparse", generateProgram(60, 0, seed));
+        // reparse() keeps nodes of the previous tree and tokens of the previous
+        // buffer, so every scanner of the chain stays alive with one context.
+        std::vector<std::unique_ptr<Scanner>> scanners;
+        ASTContext context;
+        SourceFile* current = nullptr;
+        ProgramNode* previous = nullptr;
+        std::mt19937 random(seed);
+        int chained = 0;
+        int round = 0;
+
+        for (; round < rounds; round++) {
+            if (!previous) {
+                current = base;
+                scanners.push_back(std::make_unique<Scanner>(*current));
+                scanners.back()->scan();
+                Parser parser(context, scanners.back()->getTokens());
+                parser.parse();
+                previous = parser.getAST();
+            }
+
+            std::vector<SourceEdit> edits = randomEdits(current->getText(), random);
+            SourceFile* edited = sources.applyEdits(*current, edits);
+            const TokenBuffer& previousTokens = scanners.back()->getTokens();
+            scanners.push_back(std::make_unique<Scanner>(*edited));
+            scanners.back()->relex(previousTokens, edits);
+            Parser incremental(context, scanners.back()->getTokens());
+            if (previous) {
+                incremental.reparse(previous, edits);
+            } else {
+                incremental.parse();
+            }
+
+            Scanner scanner(*edited);
+            scanner.scan();
+            ASTContext fullContext;
+            Parser full(fullContext, scanner.getTokens());
+            full.parse();
+
+            if (describe(incremental) != describe(full)) {
+                std::cout << "reparse seed " << seed << " round " << round << ": DIFFERENT\n";
+                for (const SourceEdit& edit : edits) {
+                    std::cout << "  edit at " << edit.offset << ", removed " << edit.removed
+                              << ", inserted '" << edit.inserted << "'\n";
+                }
+                ok = false;
+                break;
+            }
+            if (previous && incremental.getAST()) chained++;
+            current = edited;
+            previous = incremental.getAST();
+        }
+        std::cout << "reparse seed " << seed << ": " << round << " rounds, " << chained << " reparsed\n";
+    }
+    return ok;
+}
+
+// A JSON dump with every node ID replaced by its position in the
+// simple_chart_config list, which holds the IDs in the order they were
+// written. The two printers name nodes differently but in the same order.
+std::string readJsonWithoutIDs(const std::filesystem::path& path) {
+    std::ifstream in(path);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    const std::string text = contents.str();
+
+    const std::string listKey = "\"simple_chart_config\": [";
+    size_t list = text.rfind(listKey);
+    if (list == std::string::npos) return text;
+    std::unordered_map<std::string_view, size_t> positions;
+    for (size_t quote = text.find('"', list + listKey.size()); quote != std::string::npos;) {
+        size_t close = text.find('"', quote + 1);
+        positions.emplace(std::string_view(text).substr(quote + 1, close - quote - 1), positions.size());
+        quote = text.find_first_of("\"]", close + 1);
+        if (quote != std::string::npos && text[quote] == ']') break;
+    }
+
+    // IDs only appear as the value of "id" and "parent".
+    std::string result;
+    size_t copied = 0;
+    for (size_t at = 0; at < list; at++) {
+        size_t valueStart;
+        if (text.compare(at, 7, "\"id\": \"") == 0) {
+            valueStart = at + 7;
+        } else if (text.compare(at, 11, "\"parent\": \"") == 0) {
+            valueStart = at + 11;
+        } else {
+            continue;
+        }
+        size_t valueEnd = text.find('"', valueStart);
+        auto position = positions.find(std::string_view(text).substr(valueStart, valueEnd - valueStart));
+        if (position == positions.end()) continue;
+        result.append(text, copied, valueStart - copied);
+        result += '#' + std::to_string(position->second);
+        copied = at = valueEnd;
+    }
+    result.append(text, copied, list - copied);
+    return result;
+}
+
+// ASTPrinterJson::Print(const FlatAST&) must write the same nodes, contents
+// and parents as visiting the tree it was built from.
+bool checkFlat() {
+    SourceManager sources;
+    SourceFile* file = sources.addBuffer("flat", generateProgram(300, 0, 23));
+    Scanner scanner(*file);
+    scanner.scan();
+    ASTContext context;
+    Parser parser(context, scanner.getTokens());
+    parser.parse();
+    ProgramNode* ast = parser.getAST();
+    FlatAST flat(scanner.getTokens());
+    if (!ast || !flat.Build(*ast)) {
+        std::cout << "flat: the generated program did not build\n";
+        return false;
+    }
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    const std::filesystem::path visited = directory / "parser_checks_tree.json";
+    const std::filesystem::path flattened = directory / "parser_checks_flat.json";
+    {
+        ASTPrinterJson printer(visited.string());
+        printer.Dispatch(*ast);
+    }
+    {
+        ASTPrinterJson printer(flattened.string());
+        printer.Print(flat);
+    }
+    bool same = readJsonWithoutIDs(visited) == readJsonWithoutIDs(flattened);
+    std::filesystem::remove(visited);
+    std::filesystem::remove(flattened);
+
+    std::cout << "flat: " << flat.Size() << " records, " << (same ? "same" : "DIFFERENT") << "\n";
+    return same;
+}
+
+}
+
+int main(int argc, char** argv) {
+    Logger::getInstance().setActive(false);
+
+    std::string check = argc > 1 ? argv[1] : "";
+    if (check == "scan") return checkScan() ? 0 : 1;
+    if (check == "parallel") return checkParallel() ? 0 : 1;
+    if (check == "reparse") return checkReparse() ? 0 : 1;
+    if (check == "flat") return checkFlat() ? 0 : 1;
+
+    std::cerr << "usage: parser_checks scan|parallel|reparse|flat\n";
+    return 2;
+}